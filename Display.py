@@ -1,6 +1,6 @@
 #!/usr/bin/env python3
 try:
-    import sys, json, linecache, tkinter
+    import sys, os, json, linecache, tkinter
     from tkinter import filedialog
     from tkinter.messagebox import showerror
     from tkinter import font
@@ -8,6 +8,27 @@ except:
     print("Requires tkinter.")
     exit(1)
 
+# Line i of the jsonl file (0 is the graph data). Uses the .idx index written next to it if there is one.
+def get_line(filename, i):
+    try:
+        with open(filename + ".idx", "rb") as idx:
+            header = idx.read(24)
+            examples = int.from_bytes(header[8:16], "little")
+            idx.seek(24 + 8*(examples + 1))
+            file_size = int.from_bytes(idx.read(8), "little")
+            # Ignore the index if it doesn't belong to this version of the file.
+            if header[:8] == b"WAHLIDX\0" and file_size == os.path.getsize(filename):
+                if i > examples:
+                    return ""
+                idx.seek(24 + 8*i)
+                offset = int.from_bytes(idx.read(8), "little")
+                with open(filename, "rb") as f:
+                    f.seek(offset)
+                    return f.readline().decode()
+    except OSError:
+        pass
+    return linecache.getline(filename, i + 1)
+
 INCLUDE_INTERSECTION_MATRIX = True
 INTERSECTION_MATRIX_IN_LATEX = True
 
@@ -1050,7 +1071,7 @@ def main_window(default_filename="", default_param=""):
             if type(temp_filename) != str:
                 showerror(title="Error", message="Could not open file.")
                 return
-            s = linecache.getline(temp_filename,1)
+            s = get_line(temp_filename,0)
             if s == "":
                 showerror(title="Error", message="Could not open file.")
                 return
@@ -1063,7 +1084,7 @@ def main_window(default_filename="", default_param=""):
             if type(temp_filename) != str:
                 set_text("Error: Could not open file.")
                 return
-            s = linecache.getline(temp_filename,1)
+            s = get_line(temp_filename,0)
             if s == "":
                 set_text("Error: Could not open file.")
                 return
@@ -1103,7 +1124,7 @@ def main_window(default_filename="", default_param=""):
             number_input.insert(0, str(0))
             set_text("Loaded {}.".format(filename))
             return
-        s = linecache.getline(filename,newindex + 1)
+        s = get_line(filename,newindex)
         if s == "":
             if initial:
                 set_text("Error: Invalid index (Out of bounds).")
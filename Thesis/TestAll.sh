@@ -4,8 +4,8 @@ cd "$(dirname -- "$0")"
 
 mkdir -p data
 
-for f in ./Tests/*.txt; do
-    [ -e "$f" ] || continue
-    echo " - Testing $f"
-    ./../Search.exe "$f"
-done
\ No newline at end of file
+files=(./Tests/*.txt)
+[ -e "${files[0]}" ] || exit 0
+
+# One process for all the files, so that each one is written while the next is searched.
+./../Search.exe --batch "${files[@]}"
@@ -69,14 +69,14 @@ Data calculate_from_included (Searcher& searcher, int Original_Chern_2) {
     int used_base = 0;
 
     int double_intersections = 0;
-    for (auto& fiber : searcher.reader_copy.fibers) {
+    for (auto& fiber : searcher.reader.fibers) {
         for (auto& curve : fiber) {
             if (contains(searcher.temp_included_curves,curve)) {
                 used_base++;
             }
         }
     }
-    for (int section : searcher.reader_copy.sections) {
+    for (int section : searcher.reader.sections) {
         if (contains(searcher.temp_included_curves, section)) {
             used_base++;
         }
@@ -119,16 +119,22 @@ int main(int argc, char** argv) {
         std::cout << "Error while opening file \"" << argv[1] << "\". (Does it exist?)." << std::endl;
         return 1;
     }
-    Searcher searcher;
-    searcher.reader_copy.parse(f);
+    Reader reader;
+    reader.parse(f);
+    Searcher searcher(reader);
     f.close();
     searcher.init();
 
-    g.open(argv[2]);
+    // Exported with Export_Pretests, see Pretest_Stream.
+    g.open(argv[2], std::ios::binary);
     if (g.fail()) {
         std::cout << "Error while opening file \"" << argv[2] << "\". (Does it exist?)." << std::endl;
         return 1;
     }
+    if (!Pretest_Stream::read_magic(g)) {
+        std::cout << "File \"" << argv[2] << "\" is not a pretest file." << std::endl;
+        return 1;
+    }
 
     bool jsonl = (argc >= 4);
 
@@ -165,12 +171,12 @@ int main(int argc, char** argv) {
             searcher.temp_ignored_exceptional.clear();
             searcher.temp_included_curves.clear();
 
-            searcher.temp_self_int = searcher.reader_copy.self_int;
-            searcher.temp_included_curves = searcher.original_adj_map;
+            searcher.temp_self_int = searcher.reader.self_int;
+            searcher.temp_included_curves = searcher.reader.adj_map;
 
-            searcher.K2 = searcher.reader_copy.K.self_int;
+            searcher.K2 = searcher.reader.K.self_int;
 
-            for (int curve : searcher.reader_copy.curves_in_fibers) {
+            for (int curve : searcher.reader.curves_in_fibers) {
                 bool found = false;
                 for (int x : data["used"]) {
                     if (x == curve) {
@@ -182,7 +188,7 @@ int main(int argc, char** argv) {
                     searcher.remove_curve(curve);
                 }
             }
-            for (int curve : searcher.reader_copy.sections) {
+            for (int curve : searcher.reader.sections) {
                 bool found = false;
                 for (int x : data["used"]) {
                     if (x == curve) {
@@ -205,12 +211,12 @@ int main(int argc, char** argv) {
         }
         // std::cout << sizeAndChernFromExamples.size() << std::endl;
     }
-    long long real_test;
+    long long real_test = 0;
 
     std::vector<long long> number_tests;
-    searcher.reader_copy.get_test_numbers(number_tests);
+    searcher.reader.get_test_numbers(number_tests);
 
-    while(g >> real_test) {
+    while(Pretest_Stream::read(g, real_test)) {
         searcher.current_test = real_test;
 
         while (number_tests[searcher.test_index] + searcher.test_start <= real_test) {
@@ -220,9 +226,9 @@ int main(int argc, char** argv) {
 
         long long mask = real_test - searcher.test_start;
 
-        searcher.K2 = searcher.reader_copy.K.self_int;
+        searcher.K2 = searcher.reader.K.self_int;
 
-        if (searcher.reader_copy.curves_used_exactly == -1) {
+        if (searcher.reader.curves_used_exactly == -1) {
             // cout << "before get curves mask = " << mask << endl;
             searcher.get_curves_from_mask(mask);
             // cout << "after get curves" << endl;
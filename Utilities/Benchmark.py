@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+"""
+Times the search over fixed SubTests windows of some of the configurations in Tests, single and multi thread.
+
+Run from anywhere with
+    python3 Utilities/Benchmark.py -o bench.json
+and compare a later build against it with
+    python3 Utilities/Benchmark.py -o new.json -b bench.json
+
+The executables are compiled with SEARCH_STATS into the build directory, by default Wahl_Benchmark_build in the
+temporary directory so nothing is written into the repository. The stage times, tests, pretests and candidates come
+from the _stats.json report of each run. Peak memory is the maximum resident set size of the process.
+Every run also gets a checksum of the invariants of the examples found, so a faster build can be checked to find
+the same examples. In comparison mode the exit code is 1 if any checksum differs.
+Only works on POSIX, since it uses os.wait4.
+"""
+import os, sys, json, getopt, hashlib, subprocess, tempfile, time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+# (test file, first sub-test, end of the window). Windows are half open, as in SubTests.
+SUITE = [
+    ("Tests/9111.txt", 0, 6000),
+    ("Tests/IVs31.txt", 0, 6000),
+    ("Tests/62211.txt", 0, 6000),
+    ("Tests/4422.txt", 0, 10000),
+    ("Tests/3333.txt", 0, 3000),
+]
+
+# Settings replaced in the test files.
+REPLACED = ("Output:", "Summary_Output:", "SubTests:", "Threads:", "Export_Pretests:", "Pretest_Input:",
+            "Slowest_Tests:", "Budget_Separations:", "Budget_Candidates:", "Budget_Seconds:", "Binary_Output:")
+
+def usage():
+    print("Usage: " + sys.argv[0] + " [-o output.json] [-b baseline.json] [-t threads] [-d build_dir] [--cxx compiler] [--flags \"flags\"] [--skip-build]")
+
+def build(build_dir, cxx, flags, threads):
+    sources = [os.path.join(ROOT, "src", f) for f in sorted(os.listdir(os.path.join(ROOT, "src"))) if f.endswith(".cpp")]
+    exes = {1: os.path.join(build_dir, "Search_st.exe"), threads: os.path.join(build_dir, "Search_mt.exe")}
+    commands = [
+        [cxx, "-std=c++17"] + flags + ["-D", "SEARCH_STATS"] + sources + ["-o", exes[1]],
+        [cxx, "-std=c++17"] + flags + ["-pthread", "-D", "MULTITHREAD", "-D", "MAX_THREADS=" + str(threads), "-D", "SEARCH_STATS"] + sources + ["-o", exes[threads]],
+    ]
+    for command in commands:
+        print(" - Compiling " + os.path.basename(command[-1]))
+        subprocess.run(command, check=True)
+    return exes
+
+def make_config(test_file, start, end, threads, out):
+    lines = [
+        "Output: " + out,
+        "Summary_Output: " + out + "_sum",
+        "SubTests: " + str(start) + " - " + str(end),
+    ]
+    if threads > 1:
+        lines.append("Threads: " + str(threads))
+    with open(os.path.join(ROOT, test_file)) as f:
+        for line in f:
+            if not line.strip().startswith(REPLACED):
+                lines.append(line.rstrip("\n"))
+    config = out + "_cfg.txt"
+    with open(config, "w") as f:
+        f.write("\n".join(lines) + "\n")
+    return config
+
+def invariants(example):
+    # What identifies the singularities of an example, regardless of which configuration was found first.
+    key = [example["K2"], example["#"]] + [example.get(k) for k in ("type", "p", "q", "r", "Delta", "Omega")]
+    singularities = []
+    for chain, n in (("chain", "N"), ("chain0", "N0"), ("chain1", "N1")):
+        if chain in example and n in example:
+            disc = example["disc"]
+            singularities.append((example[n], min(-disc[example[chain][0]], -disc[example[chain][-1]])))
+    key.append(sorted(singularities))
+    return json.dumps(key)
+
+def checksum(jsonl):
+    keys = set()
+    examples = 0
+    with open(jsonl) as f:
+        f.readline() # Graph data
+        for line in f:
+            keys.add(invariants(json.loads(line)))
+            examples += 1
+    digest = hashlib.sha256("\n".join(sorted(keys)).encode()).hexdigest()
+    return examples, len(keys), digest
+
+def run(exe, test_file, start, end, threads, work_dir):
+    name = os.path.splitext(os.path.basename(test_file))[0]
+    out = os.path.join(work_dir, name + "_" + str(threads))
+    config = make_config(test_file, start, end, threads, out)
+    print(" - " + name + " " + str(start) + " - " + str(end) + ", " + str(threads) + " thread(s)")
+    with open(out + "_log.txt", "w") as log:
+        begin = time.perf_counter()
+        process = subprocess.Popen([exe, config], stdout=log, stderr=subprocess.STDOUT, cwd=work_dir)
+        _, status, rusage = os.wait4(process.pid, 0)
+        wall = time.perf_counter() - begin
+    if status != 0:
+        print("   Failed, see " + out + "_log.txt")
+        return None
+    with open(out + "_stats.json") as f:
+        stats = json.load(f)["total"]
+    candidates = sum(stats[kind]["explored"] for kind in ("single", "double", "p_extremal", "QHD_single", "QHD_double"))
+    examples, distinct, digest = checksum(out + ".jsonl")
+    # ru_maxrss is in kilobytes on Linux and in bytes on macOS.
+    peak_rss_kb = rusage.ru_maxrss // 1024 if sys.platform == "darwin" else rusage.ru_maxrss
+    return {
+        "config": test_file,
+        "window": [start, end],
+        "threads": threads,
+        "seconds": wall,
+        "subtests_per_second": (end - start) / wall,
+        "pretests_per_second": stats["passed_pretests"] / wall,
+        "candidates_per_second": candidates / wall,
+        "tests": stats["tests"],
+        "passed_pretests": stats["passed_pretests"],
+        "separations": stats["separations"],
+        "candidates": candidates,
+        "peak_rss_kb": peak_rss_kb,
+        "stage_seconds": stats["seconds"],
+        "examples": examples,
+        "distinct_invariants": distinct,
+        "checksum": digest,
+    }
+
+def compare(results, baseline_file):
+    with open(baseline_file) as f:
+        baseline = json.load(f)
+    old_runs = {(r["config"], tuple(r["window"]), r["threads"]): r for r in baseline["runs"]}
+    same = True
+    print("\n{:<20} {:>8} {:>10} {:>10} {:>8}  {}".format("config", "threads", "old s", "new s", "speedup", "checksum"))
+    for r in results:
+        old = old_runs.get((r["config"], tuple(r["window"]), r["threads"]))
+        if old is None:
+            print("{:<20} {:>8}  not in baseline".format(r["config"], r["threads"]))
+            continue
+        match = old["checksum"] == r["checksum"]
+        same = same and match
+        print("{:<20} {:>8} {:>10.2f} {:>10.2f} {:>7.2f}x  {}".format(
+            r["config"], r["threads"], old["seconds"], r["seconds"], old["seconds"] / r["seconds"], "same" if match else "DIFFERENT"))
+    return same
+
+def main(argv):
+    output = "benchmark.json"
+    baseline = None
+    threads = 4
+    build_dir = os.path.join(tempfile.gettempdir(), "Wahl_Benchmark_build")
+    cxx = "g++"
+    flags = ["-Ofast", "-flto"]
+    skip_build = False
+    try:
+        opts, _ = getopt.getopt(argv, "ho:b:t:d:", ["cxx=", "flags=", "skip-build"])
+    except getopt.GetoptError:
+        usage()
+        sys.exit(2)
+    for opt, arg in opts:
+        if opt == "-h":
+            usage()
+            sys.exit()
+        elif opt == "-o":
+            output = arg
+        elif opt == "-b":
+            baseline = arg
+        elif opt == "-t":
+            threads = int(arg)
+        elif opt == "-d":
+            build_dir = os.path.realpath(arg)
+        elif opt == "--cxx":
+            cxx = arg
+        elif opt == "--flags":
+            flags = arg.split()
+        elif opt == "--skip-build":
+            skip_build = True
+    if threads < 2:
+        # The multi thread runs are compared against the single thread ones, so they need more than one thread.
+        print("The amount of threads must be at least 2.")
+        sys.exit(2)
+
+    os.makedirs(build_dir, exist_ok=True)
+    work_dir = os.path.join(build_dir, "runs")
+    os.makedirs(work_dir, exist_ok=True)
+    if skip_build:
+        exes = {1: os.path.join(build_dir, "Search_st.exe"), threads: os.path.join(build_dir, "Search_mt.exe")}
+    else:
+        exes = build(build_dir, cxx, flags, threads)
+
+    results = []
+    for test_file, start, end in SUITE:
+        for t in sorted(exes):
+            result = run(exes[t], test_file, start, end, t, work_dir)
+            if result is not None:
+                results.append(result)
+
+    try:
+        commit = subprocess.run(["git", "rev-parse", "HEAD"], cwd=ROOT, capture_output=True, text=True).stdout.strip()
+    except OSError:
+        commit = ""
+    with open(output, "w") as f:
+        json.dump({"commit": commit, "cxx": cxx, "flags": flags, "runs": results}, f, indent=1)
+    print("Wrote " + output)
+
+    if baseline is not None and not compare(results, baseline):
+        sys.exit(1)
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -0,0 +1,92 @@
+/*
+Converts a binary database written with Binary_Output: Y back to the .jsonl format.
+The result is exactly the .jsonl file written by the search.
+Compile from the root of the repository with
+    g++ -std=c++17 -O2 Utilities/Binary_To_Jsonl.cxx src/Reader.cpp -o Binary_To_Jsonl.exe
+*/
+#include<iostream>
+#include<fstream>
+#include<vector>
+#include<cstring>
+#include"../src/Reader.hpp"
+#include"../src/Writer.hpp"
+
+template<typename T>
+T column_value(const std::vector<char>& file, const Writer::Binary_Header& header, int column, size_t i) {
+    T value;
+    std::memcpy(&value, file.data() + header.column_offset[column] + i*sizeof(T), sizeof(T));
+    return value;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " <Binary file> <jsonl file>" << std::endl;
+        return 1;
+    }
+    std::ifstream f(argv[1], std::ios::binary);
+    if (f.fail()) {
+        std::cout << "Error while opening file \"" << argv[1] << "\". (Does it exist?)." << std::endl;
+        return 1;
+    }
+    std::vector<char> file((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    f.close();
+
+    Writer::Binary_Header header;
+    if (file.size() < sizeof(header)) {
+        std::cout << "File too small to be a binary database." << std::endl;
+        return 1;
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, Writer::binary_magic, sizeof(header.magic)) != 0) {
+        std::cout << "Not a binary database, or from a different version." << std::endl;
+        return 1;
+    }
+
+    std::ofstream g(argv[2]);
+    if (g.fail()) {
+        std::cout << "Error while opening file \"" << argv[2] << "\"." << std::endl;
+        return 1;
+    }
+
+    // Only the checks are needed to write the examples.
+    Reader reader;
+    reader.nef_check = (header.checks & Writer::flag_nef_check) ? Reader::print_ : Reader::no_;
+    reader.effective_check = (header.checks & Writer::flag_effective_check) ? Reader::print_ : Reader::no_;
+    reader.obstruction_check = (header.checks & Writer::flag_obstruction_check) ? Reader::print_ : Reader::no_;
+
+    g.write(file.data() + header.graph_offset, header.graph_size);
+
+    Writer::Output_Buffer buffer;
+    Example example = Example();
+    for (size_t i = 0; i < header.examples; ++i) {
+        example.test = column_value<long long>(file, header, Writer::column_test, i);
+        example.n[0] = column_value<long long>(file, header, Writer::column_n0, i);
+        example.n[1] = column_value<long long>(file, header, Writer::column_n1, i);
+        example.a[0] = column_value<long long>(file, header, Writer::column_a0, i);
+        example.a[1] = column_value<long long>(file, header, Writer::column_a1, i);
+        example.Delta = column_value<long long>(file, header, Writer::column_Delta, i);
+        example.Omega = column_value<long long>(file, header, Writer::column_Omega, i);
+        example.K2 = column_value<int>(file, header, Writer::column_K2, i);
+        example.p = column_value<int>(file, header, Writer::column_p, i);
+        example.q = column_value<int>(file, header, Writer::column_q, i);
+        example.r = column_value<int>(file, header, Writer::column_r, i);
+        example.worm_hole_id = column_value<int>(file, header, Writer::column_worm_hole_id, i);
+        example.complete_fibers = column_value<int>(file, header, Writer::column_complete_fibers, i);
+        example.type = (Example::Type) column_value<char>(file, header, Writer::column_type, i);
+        unsigned char flags = column_value<unsigned char>(file, header, Writer::column_flags, i);
+        example.nef = flags & Writer::flag_nef;
+        example.nef_warning = flags & Writer::flag_nef_warning;
+        example.effective = flags & Writer::flag_effective;
+        example.no_obstruction = flags & Writer::flag_no_obstruction;
+        example.worm_hole = flags & Writer::flag_worm_hole;
+        example.worm_hole_conjecture_counterexample = flags & Writer::flag_worm_hole_conjecture_counterexample;
+
+        long long data_start = column_value<long long>(file, header, Writer::column_data_start, i);
+        Writer::binary_read_example_data(file.data() + header.data_offset + data_start, example);
+        Writer::export_example_data(buffer, reader, example);
+        if (buffer.size() >= (1 << 20)) buffer.write_to(g);
+    }
+    buffer.write_to(g);
+    g.close();
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+Microbenchmarks of the numeric kernels in src/Algorithms.hpp and src/QHD_functions.hpp, over generated inputs:
+Wahl chains (n,a) with n up to MAX_N, the same chains with one curve changed (almost never Wahl, like most candidates),
+Wahl chains with some blowups to reduce, QHD forks of every type from QHD_Forks.hpp, and combination indices.
+Compile from the root of the repository with
+    g++ -std=c++17 -O2 Utilities/Kernel_Bench.cxx -o Kernel_Bench.exe
+
+Usage: Kernel_Bench.exe [seconds per kernel] [filter]
+Only kernels whose name contains the filter are run. Prints the time and the heap allocations per call of each kernel.
+Allocations are counted by replacing the global operator new, so they include the reallocations of the output vectors.
+Each kernel gets one untimed pass first, so vectors reused between calls (as the search does) have their capacity already.
+*/
+#include<vector>
+#include<iostream>
+#include<iomanip>
+#include<string>
+#include<chrono>
+#include<random>
+#include<cstdlib>
+#include<new>
+#include"../src/Algorithms.hpp"
+#include"../src/QHD_functions.hpp"
+#include"QHD_Forks.hpp"
+
+using namespace std;
+
+static long long allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    if (void* ptr = malloc(size ? size : 1)) return ptr;
+    throw bad_alloc();
+}
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+// Wahl chains (n,a) with 1 <= a < n <= MAX_N.
+const int MAX_N = 60;
+// Parameters p, q, r of the QHD forks go up to MAX_PQR - 1.
+const int MAX_PQR = 8;
+// Blowups added to each Wahl chain to reduce.
+const int BLOWUPS = 3;
+const int COMBINATIONS = 4096;
+
+// Keeps results alive so the calls are not optimized away.
+static volatile long long sink;
+
+// Calls f(i) for every input i until at least 'seconds' have passed, and prints the time and allocations per call.
+template<typename F>
+void bench(const string& name, const string& filter, int inputs, double seconds, F f) {
+    if (name.find(filter) == string::npos or inputs == 0) return;
+    for (int i = 0; i < inputs; ++i) f(i);
+    long long calls = 0;
+    long long start_allocations = allocations;
+    auto start = chrono::steady_clock::now();
+    double elapsed = 0;
+    do {
+        for (int i = 0; i < inputs; ++i) f(i);
+        calls += inputs;
+        elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (elapsed < seconds);
+    long long used = allocations - start_allocations;
+    cout << left << setw(40) << name << right
+         << setw(10) << inputs << " inputs"
+         << setw(12) << fixed << setprecision(1) << elapsed*1e9/calls << " ns/op"
+         << setw(12) << setprecision(3) << (double)used/calls << " allocs/op\n";
+}
+
+struct Wahl_Input {
+    long long n, a;
+    vector<int> self_int;
+};
+
+// Adds a (-1)-curve between the curves pos - 1 and pos. Reducing the result gives the original chain.
+void blowup(vector<int>& self_int, int pos) {
+    self_int[pos-1]--;
+    self_int[pos]--;
+    self_int.insert(self_int.begin() + pos, -1);
+}
+
+int main(int argc, char** argv) {
+    double seconds = argc > 1 ? atof(argv[1]) : 0.5;
+    string filter = argc > 2 ? argv[2] : "";
+
+    mt19937 rng(12345);
+
+    vector<Wahl_Input> wahl;
+    for (long long n = 2; n <= MAX_N; ++n) {
+        for (long long a = 1; a < n; ++a) {
+            if (algs::gcd(n,a) != 1) continue;
+            wahl.push_back({n, a, {}});
+            algs::to_chain(n*n, n*a - 1, wahl.back().self_int);
+        }
+    }
+
+    // Non Wahl: one curve two more negative. Keeps every curve <= -2.
+    vector<vector<int>> non_wahl;
+    for (auto& w : wahl) {
+        non_wahl.push_back(w.self_int);
+        non_wahl.back()[rng() % w.self_int.size()] -= 2;
+    }
+
+    // Both kinds mixed, as indices over the pool of curves, as in the graph.
+    vector<int> pool;
+    vector<vector<int>> mixed_chains;
+    for (size_t i = 0; i < wahl.size(); ++i) {
+        for (const auto* self_int : {&wahl[i].self_int, &non_wahl[i]}) {
+            mixed_chains.emplace_back();
+            for (int x : *self_int) {
+                mixed_chains.back().push_back(pool.size());
+                pool.push_back(x);
+            }
+        }
+    }
+    vector<vector<int>> mixed;
+    for (size_t i = 0; i < wahl.size(); ++i) {
+        mixed.push_back(wahl[i].self_int);
+        mixed.push_back(non_wahl[i]);
+    }
+
+    // Wahl chains with blowups at random intersections.
+    vector<vector<int>> blown_up;
+    for (auto& w : wahl) {
+        if (w.self_int.size() == 1) continue;
+        blown_up.push_back(w.self_int);
+        for (int b = 0; b < BLOWUPS; ++b) {
+            blowup(blown_up.back(), 1 + rng() % (blown_up.back().size() - 1));
+        }
+    }
+    vector<vector<int>> blown_up_chains;
+    for (auto& self_int : blown_up) {
+        blown_up_chains.emplace_back();
+        for (int i = 0; i < (int)self_int.size(); ++i) blown_up_chains.back().push_back(i);
+    }
+
+    // Forks of every type.
+    struct Fork { vector<int> branches[3]; };
+    vector<Fork> forks;
+    vector<vector<int>> fork_self_int;
+    vector<algs::QHD_data> fork_data;
+    {
+        vector<int> fork[3];
+        vector<int> self_int;
+        auto add = [&]() {
+            forks.push_back({{fork[0], fork[1], fork[2]}});
+            fork_self_int.push_back(self_int);
+            fork_data.push_back(algs::get_QHD_type(fork,self_int));
+        };
+        for (int q = 0; q < MAX_PQR; ++q) {
+            generate_type_f(q,fork,self_int); add();
+            generate_type_h(q,fork,self_int); add();
+            generate_type_i(q,fork,self_int); add();
+            generate_type_j(q,fork,self_int); add();
+            for (int r = 0; r < MAX_PQR; ++r) {
+                generate_type_c(q,r,fork,self_int); add();
+                generate_type_d(q,r,fork,self_int); add();
+                generate_type_e(r,q,fork,self_int); add();
+                for (int p = 0; p < MAX_PQR; ++p) {
+                    generate_type_a(p,q,r,fork,self_int); add();
+                    generate_type_b(p,q,r,fork,self_int); add();
+                    generate_type_g(p,q,r,fork,self_int); add();
+                }
+            }
+        }
+    }
+
+    // Combinations of r out of n, as in the choice of curves of a sub-test.
+    struct Combination_Input { int n, r; long long index; };
+    vector<Combination_Input> combinations;
+    for (int i = 0; i < COMBINATIONS; ++i) {
+        int n = 20 + rng() % 41;
+        int r = 1 + rng() % 6;
+        long long index = uniform_int_distribution<long long>(0, algs::nCr(n,r) - 1)(rng);
+        combinations.push_back({n, r, index});
+    }
+
+    cout << wahl.size() << " Wahl chains with n <= " << MAX_N << ", " << fork_data.size() << " forks.\n";
+
+    bench("to_rational Wahl", filter, wahl.size(), seconds, [&](int i) {
+        sink = algs::to_rational(wahl[i].self_int).first;
+    });
+    bench("to_rational chain", filter, mixed_chains.size(), seconds, [&](int i) {
+        sink = algs::to_rational(mixed_chains[i],pool).first;
+    });
+    bench("get_wahl_numbers mixed", filter, mixed.size(), seconds, [&](int i) {
+        sink = algs::get_wahl_numbers(mixed[i]).first;
+    });
+    bench("get_wahl_numbers chain mixed", filter, mixed_chains.size(), seconds, [&](int i) {
+        sink = algs::get_wahl_numbers(mixed_chains[i],pool).first;
+    });
+    {
+        vector<long long> discrepancies;
+        bench("get_discrepancies", filter, wahl.size(), seconds, [&](int i) {
+            algs::get_discrepancies(wahl[i].n,wahl[i].a,discrepancies);
+            sink = discrepancies.back();
+        });
+    }
+    {
+        vector<long long> discrepancies(pool.size());
+        bench("get_discrepancies chain", filter, wahl.size(), seconds, [&](int i) {
+            algs::get_discrepancies(wahl[i].n,wahl[i].a,mixed_chains[2*i],discrepancies);
+            sink = discrepancies[mixed_chains[2*i].back()];
+        });
+    }
+    {
+        // reduce modifies self_int, so the copy back is part of each call.
+        vector<int> self_int, reduced_chain;
+        unordered_set<int> ignore;
+        bench("reduce", filter, blown_up.size(), seconds, [&](int i) {
+            self_int = blown_up[i];
+            sink = algs::reduce(blown_up_chains[i],self_int,reduced_chain,ignore);
+        });
+    }
+    {
+        algs::BlowDownLinkedList list;
+        bench("BlowDownLinkedList reset+reduce", filter, blown_up.size(), seconds, [&](int i) {
+            list.reset(blown_up[i].size(),blown_up_chains[i],blown_up[i]);
+            sink = list.reduce(0);
+        });
+        // Blows up the reduced chain back into the original one, which takes the curves from the stacks.
+        bench("BlowDownLinkedList +compare_forward", filter, blown_up.size(), seconds, [&](int i) {
+            list.reset(blown_up[i].size(),blown_up_chains[i],blown_up[i]);
+            list.reduce(0);
+            sink = list.compare_forward(0,blown_up[i],0);
+        });
+        vector<vector<int>> reversed(blown_up.size());
+        for (size_t i = 0; i < blown_up.size(); ++i) reversed[i].assign(blown_up[i].rbegin(),blown_up[i].rend());
+        bench("BlowDownLinkedList +compare_backward", filter, blown_up.size(), seconds, [&](int i) {
+            list.reset(blown_up[i].size(),blown_up_chains[i],blown_up[i]);
+            list.reduce(0);
+            sink = list.compare_backward(blown_up[i].size() - 1,reversed[i],1);
+        });
+    }
+    {
+        bench("get_QHD_type", filter, forks.size(), seconds, [&](int i) {
+            sink = algs::get_QHD_type(forks[i].branches,fork_self_int[i]).type;
+        });
+        vector<long long> discrepancies;
+        bench("get_QHD_discrepancies", filter, forks.size(), seconds, [&](int i) {
+            discrepancies.resize(fork_self_int[i].size());
+            sink = algs::get_QHD_discrepancies(forks[i].branches,fork_self_int[i],fork_data[i],discrepancies);
+        });
+    }
+    {
+        vector<int> result;
+        bench("ith_combination", filter, combinations.size(), seconds, [&](int i) {
+            result.resize(0);
+            algs::ith_combination(combinations[i].n,combinations[i].r,combinations[i].index,result);
+            sink = result.back();
+        });
+    }
+    bench("gcd_invmod", filter, wahl.size(), seconds, [&](int i) {
+        sink = algs::gcd_invmod(wahl[i].n*wahl[i].n,wahl[i].n*wahl[i].a - 1).second;
+    });
+}
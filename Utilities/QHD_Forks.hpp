@@ -0,0 +1,259 @@
+#pragma once
+#ifndef QHD_FORKS_HPP
+#define QHD_FORKS_HPP
+
+/*
+Forks of each type of QHD singularity, for the given parameters.
+fork[i] are the curves of the i-th branch starting with the center 0, and self_int are their self intersections.
+*/
+
+#include<vector>
+
+using std::vector;
+
+void generate_type_a(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -4;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-p-3);
+    for (int i = 0; i < p; ++i) {
+        fork[1].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-r-3);
+    for (int i = 0; i < r; ++i) {
+        fork[2].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-q-3);
+}
+
+void generate_type_b(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -3;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-3);
+    for (int i = 0; i < p; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-r-3);
+    for (int i = 0; i < r; ++i) {
+        fork[1].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-q-4);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-p-3);
+}
+
+void generate_type_c(int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -3;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-r-4);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-2);
+    for (int i = 0; i < r; ++i) {
+        fork[2].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-q-4);
+}
+
+
+void generate_type_d(int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-3);
+    for (int i = 0; i < r; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-q-5);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-r-4);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-2);
+}
+void generate_type_e(int p, int q, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-4);
+    for (int i = 0; i < p; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-q-4);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-3);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-p-3);
+}
+void generate_type_f(int q, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-2);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-3);
+    for (int i = 0; i < q; ++i) {
+        fork[2].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-q-6);
+}
+
+void generate_type_g(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-3);
+    for (int i = 0; i < r; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-3);
+    for (int i = 0; i < p; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-q-4);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-p-3);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-r-4);
+}
+
+void generate_type_h(int q, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-3);
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-q-3);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-4);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-4);
+}
+void generate_type_i(int q, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    for (int i = 0; i < q+1; ++i) {
+        fork[0].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-q-3);
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-3);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-6);
+}
+void generate_type_j(int q, vector<int> (&fork)[3], vector<int>& self_int) {
+    self_int.resize(1);
+    self_int[0] = -2;
+    for(auto& x : fork) {
+        x.resize(1);
+        x[0] = 0;
+    }
+    int id = 1;
+    fork[0].emplace_back(id++);
+    self_int.emplace_back(-2);
+    for (int i = 0; i < q+1; ++i) {
+        fork[1].emplace_back(id++);
+        self_int.emplace_back(-2);
+    }
+    fork[1].emplace_back(id++);
+    self_int.emplace_back(-q-4);
+    fork[2].emplace_back(id++);
+    self_int.emplace_back(-6);
+}
+
+#endif
@@ -1,254 +1,11 @@
 #include<vector>
 #include<iostream>
+#include<algorithm>
 #include"../src/QHD_functions.hpp"
+#include"QHD_Forks.hpp"
 
 using namespace std;
 
-void generate_type_a(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -4;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-p-3);
-    for (int i = 0; i < p; ++i) {
-        fork[1].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-r-3);
-    for (int i = 0; i < r; ++i) {
-        fork[2].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-q-3);
-}
-
-void generate_type_b(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -3;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-3);
-    for (int i = 0; i < p; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-r-3);
-    for (int i = 0; i < r; ++i) {
-        fork[1].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-q-4);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-p-3);
-}
-
-void generate_type_c(int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -3;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-r-4);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-2);
-    for (int i = 0; i < r; ++i) {
-        fork[2].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-q-4);
-}
-
-
-void generate_type_d(int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-3);
-    for (int i = 0; i < r; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-q-5);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-r-4);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-2);
-}
-void generate_type_e(int p, int q, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-4);
-    for (int i = 0; i < p; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-q-4);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-3);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-p-3);
-}
-void generate_type_f(int q, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-2);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-3);
-    for (int i = 0; i < q; ++i) {
-        fork[2].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-q-6);
-}
-
-void generate_type_g(int p, int q, int r, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-3);
-    for (int i = 0; i < r; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-3);
-    for (int i = 0; i < p; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-q-4);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-p-3);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-r-4);
-}
-
-void generate_type_h(int q, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-3);
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-q-3);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-4);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-4);
-}
-void generate_type_i(int q, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    for (int i = 0; i < q+1; ++i) {
-        fork[0].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-q-3);
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-3);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-6);
-}
-void generate_type_j(int q, vector<int> (&fork)[3], vector<int>& self_int) {
-    self_int.resize(1);
-    self_int[0] = -2;
-    for(auto& x : fork) {
-        x.resize(1);
-        x[0] = 0;
-    }
-    int id = 1;
-    fork[0].emplace_back(id++);
-    self_int.emplace_back(-2);
-    for (int i = 0; i < q+1; ++i) {
-        fork[1].emplace_back(id++);
-        self_int.emplace_back(-2);
-    }
-    fork[1].emplace_back(id++);
-    self_int.emplace_back(-q-4);
-    fork[2].emplace_back(id++);
-    self_int.emplace_back(-6);
-}
-
 const int MINTEST = 0;
 const int MAXTEST = 10;
 
@@ -273,6 +30,19 @@ bool verify_discrepancy(const vector<int> (&fork)[3], const vector<int>& self_in
     return true;
 }
 
+// The type and invariants shouldn't depend on the order in which the branches are given.
+bool verify_orders(const vector<int> (&fork)[3], const vector<int>& self_int, algs::QHD_data data) {
+    int order[3] = {0,1,2};
+    while (next_permutation(order,order+3)) {
+        vector<int> other[3] = {fork[order[0]],fork[order[1]],fork[order[2]]};
+        algs::QHD_data other_data = algs::get_QHD_type(other,self_int);
+        if (other_data.type != data.type) return false;
+        if (other_data.p != data.p or other_data.q != data.q or other_data.r != data.r) return false;
+        if (!verify_discrepancy(other,self_int,other_data)) return false;
+    }
+    return true;
+}
+
 int main(){
     vector<int> fork[3];
     vector<int> self_int;
@@ -283,24 +53,28 @@ int main(){
         if (data.type != algs::type_f) fail("type f miss");
         if (data.q != q) fail("type f q miss " + to_string(q));
         if(!verify_discrepancy(fork,self_int,data)) fail("type f disc miss " + to_string(q));
+        if(!verify_orders(fork,self_int,data)) fail("type f order miss " + to_string(q));
 
         generate_type_h(q,fork,self_int);
         data = algs::get_QHD_type(fork,self_int);
         if (data.type != algs::type_h) fail("type h miss");
         if (data.q != q) fail("type h q miss " + to_string(q));
         if(!verify_discrepancy(fork,self_int,data)) fail("type h disc miss " + to_string(q));
+        if(!verify_orders(fork,self_int,data)) fail("type h order miss " + to_string(q));
 
         generate_type_i(q,fork,self_int);
         data = algs::get_QHD_type(fork,self_int);
         if (data.type != algs::type_i) fail("type i miss");
         if (data.q != q) fail("type i q miss " + to_string(q));
         if(!verify_discrepancy(fork,self_int,data)) fail("type i disc miss " + to_string(q));
+        if(!verify_orders(fork,self_int,data)) fail("type i order miss " + to_string(q));
 
         generate_type_j(q,fork,self_int);
         data = algs::get_QHD_type(fork,self_int);
         if (data.type != algs::type_j) fail("type j miss");
         if (data.q != q) fail("type j q miss " + to_string(q));
         if(!verify_discrepancy(fork,self_int,data)) fail("type j disc miss " + to_string(q));
+        if(!verify_orders(fork,self_int,data)) fail("type j order miss " + to_string(q));
 
         for (int r = MINTEST; r < MAXTEST; ++r) {
             generate_type_c(q,r,fork,self_int);
@@ -309,6 +83,7 @@ int main(){
             if (data.q != q) fail("type c q miss " + to_string(q) + " " + to_string(r));
             if (data.r != r) fail("type c r miss " + to_string(q) + " " + to_string(r));
             if(!verify_discrepancy(fork,self_int,data)) fail("type f disc miss " + to_string(q) + " " + to_string(r));
+            if(!verify_orders(fork,self_int,data)) fail("type c order miss " + to_string(q) + " " + to_string(r));
 
             generate_type_d(q,r,fork,self_int);
             data = algs::get_QHD_type(fork,self_int);
@@ -316,6 +91,7 @@ int main(){
             if (data.q != q) fail("type d q miss " + to_string(q) + " " + to_string(r));
             if (data.r != r) fail("type d r miss " + to_string(q) + " " + to_string(r));
             if(!verify_discrepancy(fork,self_int,data)) fail("type d disc miss " + to_string(q) + " " + to_string(r));
+            if(!verify_orders(fork,self_int,data)) fail("type d order miss " + to_string(q) + " " + to_string(r));
 
             generate_type_e(r,q,fork,self_int);
             data = algs::get_QHD_type(fork,self_int);
@@ -323,6 +99,7 @@ int main(){
             if (data.p != r) fail("type c p miss " + to_string(r) + " " + to_string(q));
             if (data.q != q) fail("type c q miss " + to_string(r) + " " + to_string(q));
             if(!verify_discrepancy(fork,self_int,data)) fail("type e disc miss " + to_string(r) + " " + to_string(q));
+            if(!verify_orders(fork,self_int,data)) fail("type e order miss " + to_string(r) + " " + to_string(q));
 
             for (int p = MINTEST; p < MAXTEST; ++p) {
 
@@ -333,6 +110,7 @@ int main(){
                 if (data.q != q) fail("type a q miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if (data.r != r) fail("type a r miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if(!verify_discrepancy(fork,self_int,data)) fail("type a disc miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
+                if(!verify_orders(fork,self_int,data)) fail("type a order miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
 
                 generate_type_b(p,q,r,fork,self_int);
                 data = algs::get_QHD_type(fork,self_int);
@@ -341,6 +119,7 @@ int main(){
                 if (data.q != q) fail("type b q miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if (data.r != r) fail("type b r miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if(!verify_discrepancy(fork,self_int,data)) fail("type b disc miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
+                if(!verify_orders(fork,self_int,data)) fail("type b order miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
 
                 generate_type_g(p,q,r,fork,self_int);
                 data = algs::get_QHD_type(fork,self_int);
@@ -349,6 +128,7 @@ int main(){
                 if (data.q != q) fail("type g q miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if (data.r != r) fail("type g r miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
                 if(!verify_discrepancy(fork,self_int,data)) fail("type g disc miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
+                if(!verify_orders(fork,self_int,data)) fail("type g order miss " + to_string(p) + " " + to_string(q) + " " + to_string(r));
             }
         }
     }
@@ -0,0 +1,647 @@
+/*
+Filters and aggregates the examples of one or more result files, without python.
+Takes .wdb files (written with Binary_Output: Y) or .jsonl files, which are read faster if their .jsonl.idx index is next to them.
+Compile from the root of the repository with
+    g++ -std=c++17 -O2 -pthread Utilities/Query.cxx src/Reader.cpp -o Query.exe
+
+Usage: Query.exe [options] [filters] <files...>
+Filters are of the form field<op>value with op one of = != < <= > >=. All filters must hold. Fields:
+    K2, chains (1 or 2), kind (single, double, p_extremal, QHD_single, QHD_double), qhd (type letter, or - if not QHD),
+    n0, n1, a0, a1 (with a = min(a, n - a)), p, q, r, Delta, Omega,
+    nef, nef_warn, obs, Qef, WH, WH_CE (Y or N).
+Options:
+    --distinct f1,f2,...  Prints each distinct tuple of the given fields with its amount of examples.
+    --jsonl <file>        Writes the examples that pass the filters to a jsonl file. Only one input file.
+                          The partner of a worm hole is renumbered to its index in the output, or 0 if it is filtered out.
+    --threads <t>         Threads to use. Defaults to the hardware concurrency.
+Without --distinct nor --jsonl, prints the amount of examples that pass the filters.
+
+For example, "Query.exe K2=4 chains=2 nef=Y nef_warn=N obs=Y Qef=Y results.wdb" counts nef, unobstructed, Q-effective examples with K^2 = 4 and two chains.
+*/
+#include<iostream>
+#include<fstream>
+#include<vector>
+#include<string>
+#include<cstring>
+#include<map>
+#include<thread>
+#include<algorithm>
+#include"../src/Reader.hpp"
+#include"../src/Writer.hpp"
+
+#ifndef _WIN32
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<fcntl.h>
+#include<unistd.h>
+#endif
+
+// Whole file in memory. Memory mapped when possible.
+class Mapped_File {
+public:
+    bool open(const std::string& filename) {
+#ifndef _WIN32
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+        length = st.st_size;
+        if (length > 0) {
+            void* memory = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (memory == MAP_FAILED) {
+                ::close(fd);
+                return false;
+            }
+            mapped = static_cast<const char*>(memory);
+        }
+        ::close(fd);
+        return true;
+#else
+        std::ifstream f(filename, std::ios::binary);
+        if (f.fail()) return false;
+        copy.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+        length = copy.size();
+        return true;
+#endif
+    }
+    ~Mapped_File() {
+#ifndef _WIN32
+        if (mapped) munmap(const_cast<char*>(mapped), length);
+#endif
+    }
+    const char* data() const {
+#ifndef _WIN32
+        return mapped;
+#else
+        return copy.data();
+#endif
+    }
+    size_t size() const {
+        return length;
+    }
+
+private:
+    size_t length = 0;
+#ifndef _WIN32
+    const char* mapped = nullptr;
+#else
+    std::vector<char> copy;
+#endif
+};
+
+// Invariants and flags of an example, the only data the filters look at.
+struct Row {
+    long long n[2];
+    long long a[2];
+    long long Delta;
+    long long Omega;
+    int K2;
+    int p;
+    int q;
+    int r;
+    Example::Type type;
+    unsigned char flags;
+};
+
+enum Field {
+    field_K2,
+    field_chains,
+    field_kind,
+    field_qhd,
+    field_n0,
+    field_n1,
+    field_a0,
+    field_a1,
+    field_p,
+    field_q,
+    field_r,
+    field_Delta,
+    field_Omega,
+    field_nef,
+    field_nef_warn,
+    field_obs,
+    field_Qef,
+    field_WH,
+    field_WH_CE,
+    fields
+};
+
+const char* field_names[fields] = {
+    "K2", "chains", "kind", "qhd", "n0", "n1", "a0", "a1", "p", "q", "r", "Delta", "Omega",
+    "nef", "nef_warn", "obs", "Qef", "WH", "WH_CE"
+};
+
+const char* kind_names[5] = {"single", "QHD_single", "double", "p_extremal", "QHD_double"};
+
+int kind_of(Example::Type type) {
+    if (type == Example::single_) return 0;
+    if (type <= Example::QHD_single_j_) return 1;
+    if (type == Example::double_) return 2;
+    if (type == Example::p_extremal_) return 3;
+    return 4;
+}
+
+// QHD type as 1 to 10, 0 if not QHD.
+int qhd_of(Example::Type type) {
+    if (type >= Example::QHD_single_a_ and type <= Example::QHD_single_j_) return type - Example::QHD_single_a_ + 1;
+    if (type >= Example::QHD_double_a_ and type <= Example::QHD_double_j_) return type - Example::QHD_double_a_ + 1;
+    if (type >= Example::QHD_partial_a_ and type <= Example::QHD_partial_j_) return type - Example::QHD_partial_a_ + 1;
+    return 0;
+}
+
+long long get_field(const Row& row, int field) {
+    switch (field) {
+        case field_K2: return row.K2;
+        case field_chains: return row.type <= Example::QHD_single_j_ ? 1 : 2;
+        case field_kind: return kind_of(row.type);
+        case field_qhd: return qhd_of(row.type);
+        case field_n0: return row.n[0];
+        case field_n1: return row.n[1];
+        case field_a0: return std::min(row.a[0], row.n[0] - row.a[0]);
+        case field_a1: return std::min(row.a[1], row.n[1] - row.a[1]);
+        case field_p: return row.p;
+        case field_q: return row.q;
+        case field_r: return row.r;
+        case field_Delta: return row.Delta;
+        case field_Omega: return row.Omega;
+        case field_nef: return (row.flags & Writer::flag_nef) != 0;
+        case field_nef_warn: return (row.flags & Writer::flag_nef_warning) != 0;
+        case field_obs: return (row.flags & Writer::flag_no_obstruction) != 0;
+        case field_Qef: return (row.flags & Writer::flag_effective) != 0;
+        case field_WH: return (row.flags & Writer::flag_worm_hole) != 0;
+        case field_WH_CE: return (row.flags & Writer::flag_worm_hole_conjecture_counterexample) != 0;
+    }
+    return 0;
+}
+
+std::string field_to_string(int field, long long value) {
+    if (field == field_kind) return kind_names[value];
+    if (field == field_qhd) return value ? std::string(1, 'a' + value - 1) : std::string("-");
+    if (field >= field_nef) return value ? "Y" : "N";
+    return std::to_string(value);
+}
+
+struct Filter {
+    int field;
+    int op; // 0: =, 1: !=, 2: <, 3: <=, 4: >, 5: >=
+    long long value;
+
+    bool holds(const Row& row) const {
+        long long x = get_field(row, field);
+        switch (op) {
+            case 0: return x == value;
+            case 1: return x != value;
+            case 2: return x < value;
+            case 3: return x <= value;
+            case 4: return x > value;
+            default: return x >= value;
+        }
+    }
+};
+
+int parse_field(const std::string& name) {
+    for (int i = 0; i < fields; ++i) {
+        if (name == field_names[i]) return i;
+    }
+    std::cout << "Unknown field \"" << name << "\"." << std::endl;
+    exit(1);
+}
+
+long long parse_value(int field, const std::string& value) {
+    if (field == field_kind) {
+        for (int i = 0; i < 5; ++i) {
+            if (value == kind_names[i]) return i;
+        }
+    }
+    else if (field == field_qhd) {
+        if (value == "-") return 0;
+        if (value.size() == 1 and value[0] >= 'a' and value[0] <= 'j') return value[0] - 'a' + 1;
+    }
+    else if (field >= field_nef) {
+        if (value == "Y") return 1;
+        if (value == "N") return 0;
+    }
+    else {
+        try {
+            size_t used;
+            long long x = std::stoll(value, &used);
+            if (used == value.size()) return x;
+        }
+        catch (...) {}
+    }
+    std::cout << "Invalid value \"" << value << "\" for field " << field_names[field] << "." << std::endl;
+    exit(1);
+}
+
+bool parse_filter(const std::string& text, Filter& filter) {
+    const char* ops[6] = {"!=", "<=", ">=", "=", "<", ">"};
+    const int op_ids[6] = {1, 3, 5, 0, 2, 4};
+    for (int i = 0; i < 6; ++i) {
+        size_t position = text.find(ops[i]);
+        if (position == std::string::npos or position == 0) continue;
+        filter.field = parse_field(text.substr(0, position));
+        filter.op = op_ids[i];
+        filter.value = parse_value(filter.field, text.substr(position + std::strlen(ops[i])));
+        return true;
+    }
+    return false;
+}
+
+//////////////////////////////////////////////////////
+// Reading the examples of a file.
+
+// A result file, either binary or jsonl, giving its examples as rows.
+class Result_File {
+public:
+    bool open(const std::string& name) {
+        filename = name;
+        if (!file.open(filename)) {
+            std::cout << "Error while opening file \"" << filename << "\". (Does it exist?)." << std::endl;
+            return false;
+        }
+        if (file.size() >= sizeof(Writer::Binary_Header) and std::memcmp(file.data(), Writer::binary_magic, sizeof(Writer::binary_magic)) == 0) {
+            binary = true;
+            std::memcpy(&header, file.data(), sizeof(header));
+            examples = header.examples;
+            return true;
+        }
+        binary = false;
+        find_lines();
+        examples = line_start.size() - 2;
+        return true;
+    }
+
+    void get_row(size_t i, Row& row) const {
+        if (binary) get_binary_row(i, row);
+        else get_jsonl_row(i, row);
+    }
+
+    // Appends the example to the buffer, as a jsonl line.
+    // output_id[j] is the index in the output of example j, or -1 if it is filtered out. The partner of a worm hole
+    // gets its new index, as in Wahl::reexport, or 0 if it is filtered out.
+    void export_example(size_t i, Writer::Output_Buffer& buffer, const Reader& reader, const std::vector<long long>& output_id) const {
+        if (binary) {
+            Example example = Example();
+            Row row;
+            get_binary_row(i, row, &example);
+            if (example.type == Example::p_extremal_ and example.worm_hole and !example.worm_hole_conjecture_counterexample) {
+                example.worm_hole_id = std::max(0LL, output_id[example.worm_hole_id]);
+            }
+            Writer::export_example_data(buffer, reader, example);
+            return;
+        }
+        const char* begin = file.data() + line_start[i+1];
+        const char* end = file.data() + line_start[i+2];
+        if (number(begin, end, "WH") == 2 and !boolean(begin, end, "WH_CE")) {
+            const char* id = find_key(begin, end, "WHid");
+            const char* id_end = id;
+            while (*id_end >= '0' and *id_end <= '9') ++id_end;
+            buffer << std::string(begin, id) << std::max(0LL, output_id[read_number(id)]) << std::string(id_end, end);
+        }
+        else {
+            buffer << std::string(begin, end);
+        }
+    }
+
+    // The first line of the jsonl file.
+    std::string graph_data() const {
+        if (binary) return std::string(file.data() + header.graph_offset, header.graph_size);
+        return std::string(file.data(), file.data() + line_start[1]);
+    }
+
+    // The checks done in the search, to write the examples back to jsonl.
+    void checks(Reader& reader) const {
+        unsigned long long checks = header.checks;
+        if (!binary) {
+            std::string graph = graph_data();
+            checks = (graph.find("\"nef_check\":true") != std::string::npos ? Writer::flag_nef_check : 0) |
+                (graph.find("\"effective_check\":true") != std::string::npos ? Writer::flag_effective_check : 0) |
+                (graph.find("\"obstruction_check\":true") != std::string::npos ? Writer::flag_obstruction_check : 0);
+        }
+        reader.nef_check = (checks & Writer::flag_nef_check) ? Reader::print_ : Reader::no_;
+        reader.effective_check = (checks & Writer::flag_effective_check) ? Reader::print_ : Reader::no_;
+        reader.obstruction_check = (checks & Writer::flag_obstruction_check) ? Reader::print_ : Reader::no_;
+    }
+
+    std::string filename;
+    size_t examples;
+
+private:
+    template<typename T>
+    T column(int c, size_t i) const {
+        T value;
+        std::memcpy(&value, file.data() + header.column_offset[c] + i*sizeof(T), sizeof(T));
+        return value;
+    }
+
+    void get_binary_row(size_t i, Row& row, Example* example = nullptr) const {
+        row.n[0] = column<long long>(Writer::column_n0, i);
+        row.n[1] = column<long long>(Writer::column_n1, i);
+        row.a[0] = column<long long>(Writer::column_a0, i);
+        row.a[1] = column<long long>(Writer::column_a1, i);
+        row.Delta = column<long long>(Writer::column_Delta, i);
+        row.Omega = column<long long>(Writer::column_Omega, i);
+        row.K2 = column<int>(Writer::column_K2, i);
+        row.p = column<int>(Writer::column_p, i);
+        row.q = column<int>(Writer::column_q, i);
+        row.r = column<int>(Writer::column_r, i);
+        row.type = (Example::Type) column<char>(Writer::column_type, i);
+        row.flags = column<unsigned char>(Writer::column_flags, i);
+        if (example) {
+            example->test = column<long long>(Writer::column_test, i);
+            example->n[0] = row.n[0];
+            example->n[1] = row.n[1];
+            example->a[0] = row.a[0];
+            example->a[1] = row.a[1];
+            example->Delta = row.Delta;
+            example->Omega = row.Omega;
+            example->K2 = row.K2;
+            example->p = row.p;
+            example->q = row.q;
+            example->r = row.r;
+            example->type = row.type;
+            example->worm_hole_id = column<int>(Writer::column_worm_hole_id, i);
+            example->complete_fibers = column<int>(Writer::column_complete_fibers, i);
+            example->nef = row.flags & Writer::flag_nef;
+            example->nef_warning = row.flags & Writer::flag_nef_warning;
+            example->effective = row.flags & Writer::flag_effective;
+            example->no_obstruction = row.flags & Writer::flag_no_obstruction;
+            example->worm_hole = row.flags & Writer::flag_worm_hole;
+            example->worm_hole_conjecture_counterexample = row.flags & Writer::flag_worm_hole_conjecture_counterexample;
+            long long data_start = column<long long>(Writer::column_data_start, i);
+            Writer::binary_read_example_data(file.data() + header.data_offset + data_start, *example);
+        }
+    }
+
+    // Uses the index if it belongs to this file, otherwise looks for the line breaks.
+    void find_lines() {
+        line_start.clear();
+        Mapped_File index;
+        if (index.open(filename + ".idx") and index.size() >= 24 and std::memcmp(index.data(), Writer::index_magic, sizeof(Writer::index_magic)) == 0) {
+            unsigned long long lines;
+            std::memcpy(&lines, index.data() + 8, sizeof(lines));
+            lines += 2;
+            if (index.size() >= 24 + lines*8) {
+                line_start.resize(lines);
+                std::memcpy(line_start.data(), index.data() + 24, lines*8);
+                if (line_start.back() == file.size()) return;
+            }
+            line_start.clear();
+        }
+        line_start.push_back(0);
+        const char* begin = file.data();
+        const char* end = begin + file.size();
+        for (const char* ptr = begin; ptr < end;) {
+            const char* next = static_cast<const char*>(std::memchr(ptr, '\n', end - ptr));
+            ptr = next ? next + 1 : end;
+            line_start.push_back(ptr - begin);
+        }
+    }
+
+    // Position right after "key": in the line, or nullptr.
+    static const char* find_key(const char* begin, const char* end, const char* key) {
+        const size_t length = std::strlen(key);
+        for (const char* ptr = begin; ptr + length + 3 <= end; ++ptr) {
+            ptr = static_cast<const char*>(std::memchr(ptr, '\"', end - ptr));
+            if (!ptr or ptr + length + 3 > end) return nullptr;
+            if (std::memcmp(ptr + 1, key, length) == 0 and ptr[length + 1] == '\"' and ptr[length + 2] == ':') return ptr + length + 3;
+        }
+        return nullptr;
+    }
+
+    static long long read_number(const char* ptr) {
+        bool negative = (*ptr == '-');
+        if (negative) ++ptr;
+        long long x = 0;
+        while (*ptr >= '0' and *ptr <= '9') x = 10*x + (*ptr++ - '0');
+        return negative ? -x : x;
+    }
+
+    static long long number(const char* begin, const char* end, const char* key) {
+        const char* ptr = find_key(begin, end, key);
+        return ptr ? read_number(ptr) : 0;
+    }
+
+    static bool boolean(const char* begin, const char* end, const char* key) {
+        const char* ptr = find_key(begin, end, key);
+        return ptr and *ptr == 't';
+    }
+
+    // Element i of the array of numbers with the given key. If i < 0, counts from the end.
+    static long long array_element(const char* begin, const char* end, const char* key, long long i) {
+        const char* ptr = find_key(begin, end, key);
+        if (!ptr) return 0;
+        const char* close = static_cast<const char*>(std::memchr(ptr, ']', end - ptr));
+        if (i < 0) {
+            ptr = close;
+            while (i++ < 0) {
+                --ptr;
+                while (*ptr != ',' and *ptr != '[') --ptr;
+            }
+            return read_number(ptr + 1);
+        }
+        ++ptr;
+        while (i-- > 0) ptr = static_cast<const char*>(std::memchr(ptr, ',', close - ptr)) + 1;
+        return read_number(ptr);
+    }
+
+    // a = min(-disc[first curve], -disc[last curve]) for the chain with the given key, as in Thesis/analyse.py.
+    static long long chain_a(const char* begin, const char* end, const char* key) {
+        long long first = array_element(begin, end, key, 0);
+        long long last = array_element(begin, end, key, -1);
+        return std::min(-array_element(begin, end, "disc", first), -array_element(begin, end, "disc", last));
+    }
+
+    void get_jsonl_row(size_t i, Row& row) const {
+        const char* begin = file.data() + line_start[i+1];
+        const char* end = file.data() + line_start[i+2];
+        row = Row();
+        row.K2 = number(begin, end, "K2");
+        const bool single = number(begin, end, "#") == 1;
+        const char* type = find_key(begin, end, "type");
+        int wh = single ? 0 : number(begin, end, "WH");
+        if (type) {
+            int letter = type[1] - 'a';
+            row.type = (Example::Type)((single ? Example::QHD_single_a_ : Example::QHD_double_a_) + letter);
+            row.p = number(begin, end, "p");
+            row.q = number(begin, end, "q");
+            row.r = number(begin, end, "r");
+        }
+        else if (single) row.type = Example::single_;
+        else row.type = wh ? Example::p_extremal_ : Example::double_;
+
+        // a is not in the jsonl file, it is recovered from the discrepancies, already uniformized.
+        if (single) {
+            row.n[0] = number(begin, end, "N");
+            if (!type) row.a[0] = chain_a(begin, end, "chain");
+        }
+        else {
+            row.n[0] = number(begin, end, "N0");
+            row.n[1] = number(begin, end, "N1");
+            if (!type) {
+                row.a[0] = chain_a(begin, end, "chain0");
+                row.a[1] = chain_a(begin, end, "chain1");
+            }
+            else {
+                row.a[1] = chain_a(begin, end, "chain");
+            }
+        }
+        if (row.type == Example::p_extremal_) {
+            row.Delta = number(begin, end, "Delta");
+            row.Omega = number(begin, end, "Omega");
+            if (boolean(begin, end, "WH_CE")) row.flags |= Writer::flag_worm_hole_conjecture_counterexample;
+            if (wh == 2) row.flags |= Writer::flag_worm_hole;
+        }
+        if (boolean(begin, end, "nef")) row.flags |= Writer::flag_nef;
+        if (boolean(begin, end, "nef_warn")) row.flags |= Writer::flag_nef_warning;
+        if (boolean(begin, end, "obs")) row.flags |= Writer::flag_no_obstruction;
+        if (boolean(begin, end, "Qef")) row.flags |= Writer::flag_effective;
+    }
+
+    Mapped_File file;
+    bool binary;
+    Writer::Binary_Header header = {};
+    std::vector<unsigned long long> line_start;
+};
+
+//////////////////////////////////////////////////////
+
+int main(int argc, char** argv) {
+    std::vector<Filter> filters;
+    std::vector<int> distinct;
+    std::vector<std::string> filenames;
+    std::string jsonl_output;
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--distinct" and i + 1 < argc) {
+            std::string list = argv[++i];
+            size_t start = 0;
+            while (start <= list.size()) {
+                size_t comma = list.find(',', start);
+                if (comma == std::string::npos) comma = list.size();
+                distinct.push_back(parse_field(list.substr(start, comma - start)));
+                start = comma + 1;
+            }
+        }
+        else if (arg == "--jsonl" and i + 1 < argc) {
+            jsonl_output = argv[++i];
+        }
+        else if (arg == "--threads" and i + 1 < argc) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        }
+        else {
+            Filter filter;
+            if (arg.find('=') != std::string::npos or arg.find('<') != std::string::npos or arg.find('>') != std::string::npos) {
+                if (!parse_filter(arg, filter)) {
+                    std::cout << "Invalid filter \"" << arg << "\"." << std::endl;
+                    return 1;
+                }
+                filters.push_back(filter);
+            }
+            else {
+                filenames.push_back(arg);
+            }
+        }
+    }
+    if (filenames.empty()) {
+        std::cout << "Usage: " << argv[0] << " [--distinct f1,f2,...] [--jsonl output] [--threads t] [filters] <files...>" << std::endl;
+        return 1;
+    }
+    if (!jsonl_output.empty() and filenames.size() != 1) {
+        std::cout << "--jsonl takes only one input file, since the graph data of each file is different." << std::endl;
+        return 1;
+    }
+
+    long long total = 0;
+    std::map<std::vector<long long>, long long> distinct_count;
+
+    for (const std::string& filename : filenames) {
+        Result_File file;
+        if (!file.open(filename)) return 1;
+
+        // Each thread takes a contiguous range of examples, so the filtered jsonl keeps the order.
+        const size_t size = file.examples;
+        const size_t range = (size + threads - 1)/threads;
+        std::vector<long long> counts(threads, 0);
+        std::vector<std::map<std::vector<long long>, long long>> distinct_counts(threads);
+        std::vector<Writer::Output_Buffer> buffers(jsonl_output.empty() ? 0 : threads);
+        // With --jsonl, the index in the output of each example, or -1 if it is filtered out.
+        std::vector<long long> output_id(jsonl_output.empty() ? 0 : size, -1);
+        Reader reader;
+        if (!jsonl_output.empty()) file.checks(reader);
+
+        auto work = [&] (int t) {
+            Row row;
+            std::vector<long long> key(distinct.size());
+            for (size_t i = t*range; i < std::min(size, (t + 1)*range); ++i) {
+                file.get_row(i, row);
+                bool passed = true;
+                for (const Filter& filter : filters) {
+                    if (!filter.holds(row)) {
+                        passed = false;
+                        break;
+                    }
+                }
+                if (!passed) continue;
+                counts[t]++;
+                if (!distinct.empty()) {
+                    for (size_t j = 0; j < distinct.size(); ++j) key[j] = get_field(row, distinct[j]);
+                    distinct_counts[t][key]++;
+                }
+                if (!jsonl_output.empty()) output_id[i] = 0;
+            }
+        };
+        std::vector<std::thread> spawns;
+        for (int t = 0; t < threads; ++t) spawns.emplace_back(work, t);
+        for (auto& spawn : spawns) spawn.join();
+
+        // The examples are written once all output indexes are known, since a worm hole may come before its partner.
+        if (!jsonl_output.empty()) {
+            long long next = 0;
+            for (long long& id : output_id) {
+                if (id == 0) id = next++;
+            }
+            auto export_range = [&] (int t) {
+                for (size_t i = t*range; i < std::min(size, (t + 1)*range); ++i) {
+                    if (output_id[i] >= 0) file.export_example(i, buffers[t], reader, output_id);
+                }
+            };
+            spawns.clear();
+            for (int t = 0; t < threads; ++t) spawns.emplace_back(export_range, t);
+            for (auto& spawn : spawns) spawn.join();
+        }
+
+        for (int t = 0; t < threads; ++t) {
+            total += counts[t];
+            for (auto& entry : distinct_counts[t]) distinct_count[entry.first] += entry.second;
+        }
+
+        if (!jsonl_output.empty()) {
+            std::ofstream g(jsonl_output, std::ios::binary);
+            if (g.fail()) {
+                std::cout << "Error while opening file \"" << jsonl_output << "\"." << std::endl;
+                return 1;
+            }
+            g << file.graph_data();
+            for (auto& buffer : buffers) buffer.write_to(g);
+            g.close();
+        }
+    }
+
+    if (!distinct.empty()) {
+        for (auto& entry : distinct_count) {
+            for (size_t j = 0; j < distinct.size(); ++j) {
+                std::cout << (j ? " " : "") << field_names[distinct[j]] << '=' << field_to_string(distinct[j], entry.first[j]);
+            }
+            std::cout << ": " << entry.second << '\n';
+        }
+        std::cout << distinct_count.size() << " distinct, ";
+    }
+    std::cout << total << " examples." << std::endl;
+    return 0;
+}
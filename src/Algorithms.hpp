@@ -12,6 +12,7 @@ Some general purpose algorithms and structures.
 #include<unordered_set> // unordered_set
 #include<climits> // INT_MAX
 #include<stack> // stack
+#include<cmath> // sqrt
 
 namespace algs {
 
@@ -44,6 +45,14 @@ namespace algs {
         return a/gcd(a,b)*b;
     }
 
+    // Returns floor(sqrt(x)). Assumes x > 0. Compares with divisions so that it doesn't overflow.
+    static long long isqrt(long long x) {
+        long long r = (long long)std::sqrt((double)x);
+        while (r > x/r) r--;
+        while (r+1 <= x/(r+1)) r++;
+        return r;
+    }
+
     // Assigns to result the resolution of the singularity represented by m/q
     static void to_chain(long long m, long long q, std::vector<int>& result) {
         result.resize(0);
@@ -96,6 +105,28 @@ namespace algs {
         return {a,b};
     }
 
+    // Returns the pair (n,a) if nn/b represents a Wahl singularity, that is, nn = n^2 and b = na - 1 with gcd(n,a) = 1. If not Wahl, returns (0,0).
+    // Almost every candidate fails, so first discard non squares, which is cheaper than the gcd of nn and b + 1.
+    static std::pair<long long, long long>
+    wahl_numbers_from_rational(long long nn, long long b) {
+        if (nn <= 0) {
+            return {0,0};
+        }
+        long long n = isqrt(nn);
+        if (n*n != nn) {
+            return {0,0};
+        }
+        long long na = b + 1;
+        if (na%n) {
+            return {0,0};
+        }
+        long long a = na/n;
+        if (a > n or gcd(n,a) != 1) {
+            return {0,0};
+        }
+        return {n,a};
+    }
+
     // Returns the pair (n,a) of a Wahl singularity. If not Wahl, returns (0,0).
     // Assumes admissible
     static std::pair<long long, long long>
@@ -106,40 +137,55 @@ namespace algs {
         if (rational.second == -1) return {-1,-1};
 #endif
 
-        long long nn = rational.first;
-        long long na = rational.second + 1;
-        long long n = gcd(nn,na);
-        if (n*n != nn) {
-            return {0,0};
+        return wahl_numbers_from_rational(rational.first, rational.second);
+    }
+
+    /*
+    Necessary conditions for a chain [b_1,...,b_r] (b_i = -C_i^2) to be Wahl. Every Wahl chain is obtained from [4] by the operations
+        [b_1,...,b_r] -> [2,b_1,...,b_r + 1] and [b_1,...,b_r] -> [b_1 + 1,...,b_r,2],
+    so that sum(b_i - 3) = 1, and if r > 1 exactly one end is a 2. If b_1 > 2, the chain ends in exactly b_1 - 2 (-2)-curves, unless
+    the chain is [b_1,2,...,2] with b_1 - 4 of them. Same with b_r > 2.
+    Only additions and comparisons, so it discards almost every candidate before doing the continued fraction.
+    Returns true if it could be Wahl, or if some b_i < 2, as then none of this applies.
+    */
+    static bool could_be_wahl(const std::vector<int>& chain, const std::vector<int>& self_int) {
+        const int r = chain.size();
+        int sum = 0;
+        for (int curve : chain) {
+            if (self_int[curve] > -2) return true;
+            sum -= self_int[curve] + 3;
         }
-        long long a = na/n;
-        if (a > n) {
-            return {0,0};
+        if (sum != 1) return false;
+        if (r == 1) return true;
+        int first = -self_int[chain[0]];
+        int last = -self_int[chain.back()];
+        if ((first == 2) == (last == 2)) return false;
+        int big = first;
+        int twos = 0;
+        if (first == 2) {
+            big = last;
+            for (int i = 0; self_int[chain[i]] == -2; ++i) twos++;
         }
-        return {n,a};
+        else {
+            for (int i = r - 1; self_int[chain[i]] == -2; --i) twos++;
+        }
+        return twos == big - 2 or (twos == big - 4 and twos == r - 1);
     }
 
     // Returns the pair (n,a) of a Wahl singularity. If not Wahl, returns (0,0).
     // This version takes a vector of references to self intersections.
     static std::pair<long long, long long>
     get_wahl_numbers(const std::vector<int>& chain, const std::vector<int>& self_int) {
+        if (!could_be_wahl(chain,self_int)) {
+            return {0,0};
+        }
         auto rational = to_rational(chain,self_int);
 
 #ifdef OVERFLOW_CHECK
         if (rational.second == -1) return {-1,-1};
 #endif
 
-        long long nn = rational.first;
-        long long na = rational.second + 1;
-        long long n = gcd(nn,na);
-        if (n*n != nn) {
-            return {0,0};
-        }
-        long long a = na/n;
-        if (a > n) {
-            return {0,0};
-        }
-        return {n,a};
+        return wahl_numbers_from_rational(rational.first, rational.second);
     }
 
 
@@ -545,6 +591,36 @@ namespace algs {
             result.emplace_back(N-1-n);
         }
     }
+
+    // Appends x to bytes using 7 bits per byte, the highest bit marks that more bytes follow.
+    static void put_varint(std::vector<unsigned char>& bytes, unsigned long long x) {
+        while (x >= 0x80) {
+            bytes.push_back((unsigned char)(x | 0x80));
+            x >>= 7;
+        }
+        bytes.push_back((unsigned char) x);
+    }
+
+    // Reads a number written with put_varint and advances ptr past it.
+    static unsigned long long get_varint(const unsigned char*& ptr) {
+        unsigned long long x = 0;
+        int shift = 0;
+        while (*ptr & 0x80) {
+            x |= (unsigned long long)(*ptr++ & 0x7f) << shift;
+            shift += 7;
+        }
+        x |= (unsigned long long)(*ptr++) << shift;
+        return x;
+    }
+
+    // Maps integers of small absolute value to small unsigned numbers, so they take few bytes with put_varint.
+    static unsigned long long zigzag(long long x) {
+        return ((unsigned long long) x << 1) ^ (unsigned long long)(x >> 63);
+    }
+
+    static long long unzigzag(unsigned long long x) {
+        return (long long)(x >> 1) ^ -(long long)(x & 1);
+    }
 }
 
 #endif
@@ -0,0 +1,220 @@
+#pragma once
+#ifndef INVARIANT_TABLE_HPP
+#define INVARIANT_TABLE_HPP
+#include"config.hpp"
+#include<climits> // LLONG_MAX
+#include<vector> // vector
+#include<algorithm> // fill
+
+#ifdef SHARE_FOUND_INVARIANTS
+#include<atomic> // atomic
+#include<memory> // unique_ptr
+#include<thread> // yield
+#endif
+
+/*
+Invariants of an example packed in four words, to find repeated examples.
+word[0] has the kind of example, its type (only for QHD) and K^2. The rest depends on the kind:
+    single: (n,a)
+    double: (n0,a0), (n1,a1)
+    P-extremal: Delta, Omega
+    QHD single: (p,q), r
+    QHD double: (p,q), r, (n,a)
+Pairs are packed in the high and low 32 bits of a word. Since n^2 fits in a long long, n and a fit in 32 bits.
+The invariants are assumed uniformized, so that equal examples give equal keys.
+*/
+struct Invariant_Key {
+    enum Kind : unsigned char {
+        single_ = 1,
+        double_,
+        p_extremal_,
+        single_QHD_,
+        double_QHD_
+    };
+    unsigned long long word[4];
+
+    inline bool operator==(const Invariant_Key& other) const {
+        return word[0] == other.word[0] and word[1] == other.word[1] and word[2] == other.word[2] and word[3] == other.word[3];
+    }
+
+    static inline unsigned long long pack(long long high, long long low) {
+        return ((unsigned long long) high << 32) | (unsigned long long)(unsigned int) low;
+    }
+    static inline Invariant_Key make(Kind kind, char type, int K2, unsigned long long x, unsigned long long y = 0, unsigned long long z = 0) {
+        return {{((unsigned long long) kind << 56) | ((unsigned long long)(unsigned char) type << 48) | (unsigned long long)(unsigned int) K2, x, y, z}};
+    }
+
+    static inline Invariant_Key single(int K2, long long n, long long a) {
+        return make(single_, 0, K2, pack(n,a));
+    }
+    static inline Invariant_Key double_chain(int K2, long long n0, long long a0, long long n1, long long a1) {
+        return make(double_, 0, K2, pack(n0,a0), pack(n1,a1));
+    }
+    static inline Invariant_Key p_extremal(int K2, long long Delta, long long Omega) {
+        return make(p_extremal_, 0, K2, Delta, Omega);
+    }
+    static inline Invariant_Key single_QHD(int K2, char type, int p, int q, int r) {
+        return make(single_QHD_, type, K2, pack(p,q), r);
+    }
+    static inline Invariant_Key double_QHD(int K2, char type, int p, int q, int r, long long n, long long a) {
+        return make(double_QHD_, type, K2, pack(p,q), r, pack(n,a));
+    }
+};
+
+// Mixes all the bits of x (finalizer of splitmix64).
+inline unsigned long long mix_bits(unsigned long long x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ull;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebull;
+    x ^= x >> 31;
+    return x;
+}
+
+struct Invariant_Key_Hash {
+    inline size_t operator()(const Invariant_Key& key) const {
+        return mix_bits(key.word[0] + mix_bits(key.word[1] + mix_bits(key.word[2] + mix_bits(key.word[3]))));
+    }
+};
+
+// Set of invariants, with open addressing and linear probing over a flat array.
+// A slot is empty if word[0] is zero, which never happens for a valid key since the kind is at least 1.
+class Invariant_Set {
+public:
+    inline bool contains(const Invariant_Key& key) const {
+        if (slots.empty()) return false;
+        for (size_t i = Invariant_Key_Hash()(key) & mask;; i = (i + 1) & mask) {
+            if (slots[i].word[0] == 0) return false;
+            if (slots[i] == key) return true;
+        }
+    }
+
+    // Returns true if the key was not in the set.
+    inline bool insert(const Invariant_Key& key) {
+        if ((used + 1)*4 > slots.size()*3) grow();
+        size_t i = Invariant_Key_Hash()(key) & mask;
+        for (; slots[i].word[0] != 0; i = (i + 1) & mask) {
+            if (slots[i] == key) return false;
+        }
+        slots[i] = key;
+        ++used;
+        return true;
+    }
+
+    // Keeps the capacity.
+    inline void clear() {
+        if (used == 0) return;
+        std::fill(slots.begin(), slots.end(), Invariant_Key{});
+        used = 0;
+    }
+
+    inline size_t size() const {
+        return used;
+    }
+
+private:
+    inline void grow() {
+        std::vector<Invariant_Key> old(slots.empty() ? 16 : 2*slots.size(), Invariant_Key{});
+        old.swap(slots);
+        mask = slots.size() - 1;
+        used = 0;
+        for (const Invariant_Key& key : old) {
+            if (key.word[0] != 0) insert(key);
+        }
+    }
+
+    std::vector<Invariant_Key> slots;
+    size_t mask = 0;
+    size_t used = 0;
+};
+
+inline bool contains(const Invariant_Set& S, const Invariant_Key& key) {
+    return S.contains(key);
+}
+
+#ifdef SHARE_FOUND_INVARIANTS
+
+// Table from invariants to the smallest test where some thread found an example with them. Shared by all threads.
+// It has fixed size, slots are claimed with a compare and swap and never removed, and the test is lowered with compare and swap.
+// If the table gets too full, new invariants are not added. This only means that less examples get skipped before merging.
+class Shared_Invariant_Table {
+public:
+    inline void init(int log_size) {
+        mask = (size_t(1) << log_size) - 1;
+        max_used = (mask + 1)/4*3;
+        used = 0;
+        slots.reset(new Slot[mask + 1]);
+    }
+
+    // Returns LLONG_MAX if no example with these invariants was found.
+    inline long long first_test(const Invariant_Key& key) const {
+        if (!slots) return LLONG_MAX;
+        const size_t hash = Invariant_Key_Hash()(key);
+        for (size_t i = hash & mask, probes = 0; probes <= mask; i = (i + 1) & mask, ++probes) {
+            const Slot& slot = slots[i];
+            char state = wait_ready(slot);
+            if (state == empty_) return LLONG_MAX;
+            if (slot.hash == hash and slot.key == key) return slot.test.load(std::memory_order_relaxed);
+        }
+        return LLONG_MAX;
+    }
+
+    inline void update(const Invariant_Key& key, long long test) {
+        if (!slots) return;
+        const size_t hash = Invariant_Key_Hash()(key);
+        for (size_t i = hash & mask, probes = 0; probes <= mask; i = (i + 1) & mask, ++probes) {
+            Slot& slot = slots[i];
+            char state = slot.state.load(std::memory_order_acquire);
+            if (state == empty_) {
+                if (used.load(std::memory_order_relaxed) >= max_used) return;
+                if (slot.state.compare_exchange_strong(state, writing_, std::memory_order_acquire)) {
+                    used.fetch_add(1,std::memory_order_relaxed);
+                    slot.hash = hash;
+                    slot.key = key;
+                    slot.test.store(test,std::memory_order_relaxed);
+                    slot.state.store(ready_,std::memory_order_release);
+                    return;
+                }
+                // Some other thread claimed the slot, check if it's the same key.
+            }
+            wait_ready(slot);
+            if (slot.hash == hash and slot.key == key) {
+                long long previous = slot.test.load(std::memory_order_relaxed);
+                while (test < previous and !slot.test.compare_exchange_weak(previous, test, std::memory_order_relaxed));
+                return;
+            }
+        }
+    }
+
+private:
+    enum State : char {
+        empty_,
+        writing_,
+        ready_
+    };
+    struct Slot {
+        std::atomic<char> state{empty_};
+        size_t hash;
+        Invariant_Key key;
+        std::atomic<long long> test;
+    };
+
+    // The slot is only being written for a moment, so just spin.
+    static inline char wait_ready(const Slot& slot) {
+        char state = slot.state.load(std::memory_order_acquire);
+        while (state == writing_) {
+            std::this_thread::yield();
+            state = slot.state.load(std::memory_order_acquire);
+        }
+        return state;
+    }
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    size_t max_used;
+    std::atomic<size_t> used;
+};
+
+#endif // SHARE_FOUND_INVARIANTS
+
+#endif
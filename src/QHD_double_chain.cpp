@@ -2,6 +2,7 @@
 #include"Reader.hpp"
 #include"Algorithms.hpp"
 #include"QHD_functions.hpp"
+#include<algorithm> // reverse
 
 using std::vector;
 using std::pair;
@@ -80,8 +81,9 @@ void Searcher::search_for_QHD3_double_chain() {
 
     G.begin_search();
     do {
+        separations++;
         if (G.frame == -1) {
-            if (reader_copy.search_double_chain) {
+            if (reader.search_double_chain) {
                 search_for_double_chain_inner_loop<true,true>();
             }
             else {
@@ -482,7 +484,7 @@ void Searcher::search_for_QHD3_double_chain() {
                 continue;
             }
         }
-    } while(G.next_candidate_QHD3());
+    } while(!over_budget() and G.next_candidate_QHD3());
 }
 
 
@@ -583,6 +585,9 @@ void Searcher::get_fork_from_two_chains_for_double(vector<int> (&chain)[2]) {
 */
 
 void Searcher::explore_QHD3_double_candidate(vector<int> (&fork)[3], vector<int>& chain, int extra_id, int extra_n, int extra_orig, int extra_pos) {
+    if (over_budget()) return;
+    candidates++;
+    STATS(stats.explored[Search_Stats::kind_QHD_double]++;)
 
     THREAD_STATIC vector<int> location;
 
@@ -841,8 +846,13 @@ void Searcher::explore_QHD3_partial_resolution(std::vector<int> (&fork)[3], int
 
 
 void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], const std::vector<int>& chain, const std::vector<int>& local_self_int, int extra_n[2], int extra_orig[2], int extra_pos[2], int extra_id) {
+    STATS(stats.reduced[Search_Stats::kind_QHD_double]++;)
     auto QHD_invariants = algs::get_QHD_type(fork,local_self_int);
     if (QHD_invariants.type == algs::QHD_Type::none) return;
+    if (reader.search_targets and (
+        !contains(reader.target_QHD,std::make_tuple((char)QHD_invariants.type,QHD_invariants.p,QHD_invariants.q,QHD_invariants.r)) or
+        !contains(reader.target_wahl_lengths,(int)chain.size())
+    )) return;
 
     auto chain_invariants = algs::get_wahl_numbers(chain,local_self_int);
 
@@ -858,7 +868,10 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
 #endif
 
     if (chain_invariants.first == 0) return;
-    double_QHD_invariant unif_invariants(
+    if (reader.search_targets and !contains(reader.target_wahl,
+        std::make_pair(chain_invariants.first,std::min(chain_invariants.second,chain_invariants.first - chain_invariants.second)))) return;
+    STATS(stats.hits[Search_Stats::kind_QHD_double]++;)
+    const Invariant_Key key = Invariant_Key::double_QHD(
         current_K2,
         QHD_invariants.type,
         QHD_invariants.p,
@@ -867,7 +880,16 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
         chain_invariants.first,
         std::min(chain_invariants.second, chain_invariants.first - chain_invariants.second)
     );
-    if (reader_copy.keep_first != Reader::no_ and contains(double_QHD_found,unif_invariants)) return;
+    if (keep_first != Reader::no_ and contains(double_QHD_found,key)) {
+        STATS(stats.repeated[Search_Stats::kind_QHD_double]++;)
+        return;
+    }
+#ifdef SHARE_FOUND_INVARIANTS
+    if (found_before(key)) {
+        STATS(stats.repeated[Search_Stats::kind_QHD_double]++;)
+        return;
+    }
+#endif
     THREAD_STATIC vector<long long> discrepancies;
     discrepancies.resize(local_self_int.size(),0);
     long long QHD_denominator = algs::get_QHD_discrepancies(fork,local_self_int,QHD_invariants,discrepancies);
@@ -881,19 +903,21 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
     long long n[2] = {QHD_denominator,chain_invariants.first};
 
     pair<bool,bool> nef_result;
-    if (reader_copy.nef_check != Reader::no_) {
+    if (check_now(reader.nef_check)) {
         int borders[2] = {extra_id,chain.back()};
         nef_result = double_is_nef(local_self_int,discrepancies,location,n,extra_n,extra_orig,extra_pos,borders);
     }
-    if (reader_copy.nef_check == Reader::skip_ and !nef_result.first) {
+    if (reader.nef_check == Reader::skip_ and !nef_result.first) {
+        STATS(stats.not_nef[Search_Stats::kind_QHD_double]++;)
         return;
     }
 
     bool effective = false;
-    if (reader_copy.effective_check != Reader::no_) {
+    if (check_now(reader.effective_check)) {
         effective = double_is_effective(local_self_int,discrepancies,location,n);
     }
-    if (reader_copy.effective_check == Reader::skip_ and !effective) {
+    if (reader.effective_check == Reader::skip_ and !effective) {
+        STATS(stats.not_effective[Search_Stats::kind_QHD_double]++;)
         return;
     }
 
@@ -905,7 +929,7 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
     example.K2 = current_K2;
     example.complete_fibers = current_complete_fibers;
     example.used_curves.insert(curve_translate.begin(),curve_translate.end());
-    for (int exceptional : reader_copy.K.used_components) {
+    for (int exceptional : reader.K.used_components) {
         if (temp_self_int[exceptional] == INT_MAX) {
             example.blown_down_exceptionals.insert(exceptional);
         }
@@ -926,6 +950,8 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
     example.extra_orig[1] = extra_orig[1];
     example.extra_pos[0] = extra_pos[0];
     example.extra_pos[1] = extra_pos[1];
+    example.extra_border[0] = extra_id;
+    example.extra_border[1] = chain.back();
 
     example.chain[0].reserve(fork[0].size() + fork[1].size() + fork[2].size());
     for (int i = 0; i < 3; ++i) {
@@ -939,9 +965,12 @@ void Searcher::verify_QHD3_double_candidate(const std::vector<int> (&fork)[3], c
     example.nef_warning = nef_result.second;
     example.effective = effective;
 
-    results->push(std::move(example));
+    push_result(example);
 
-    if (reader_copy.keep_first != Reader::no_) {
-        double_QHD_found.insert(unif_invariants);
+    if (keep_first != Reader::no_) {
+        double_QHD_found.insert(key);
     }
+#ifdef SHARE_FOUND_INVARIANTS
+    share_found(key);
+#endif
 }
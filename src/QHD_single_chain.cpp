@@ -38,8 +38,9 @@ void Searcher::search_for_QHD3_single_chain() {
 
     G.begin_search();
     do {
+        separations++;
         if (G.frame == -1) {
-            if (reader_copy.search_single_chain) {
+            if (reader.search_single_chain) {
                 search_for_single_chain_inner_loop<true,true>();
             }
             else {
@@ -101,7 +102,7 @@ void Searcher::search_for_QHD3_single_chain() {
         else {
             verify_QHD3_single_candidate(fork);
         }
-    } while(G.next_candidate_QHD3());
+    } while(!over_budget() and G.next_candidate_QHD3());
 }
 
 void Searcher::get_fork_from_one_chain_for_single(const vector<int>& chain) {
@@ -141,6 +142,9 @@ void Searcher::get_fork_from_one_chain_for_single(const vector<int>& chain) {
 }
 
 void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int extra_id, int extra_n, int extra_orig, int extra_pos) {
+    if (over_budget()) return;
+    candidates++;
+    STATS(stats.explored[Search_Stats::kind_QHD_single]++;)
 
     THREAD_STATIC std::vector<int> reduced_self_int;
     reduced_self_int = G.self_int;
@@ -150,11 +154,23 @@ void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int ex
                       && algs::reduce(fork[1],reduced_self_int,reduced_fork[1],empty_set)
                       && algs::reduce(fork[2],reduced_self_int,reduced_fork[2],empty_set);
     if (!admissible) return;
+    STATS(stats.reduced[Search_Stats::kind_QHD_single]++;)
     auto data = algs::get_QHD_type(reduced_fork,reduced_self_int);
     if (data.type == algs::QHD_Type::none) return;
+    if (reader.search_targets and !contains(reader.target_QHD,std::make_tuple((char)data.type,data.p,data.q,data.r))) return;
 
-    single_QHD_invariant invariant(current_K2, data.type, data.p,data.q,data.r);
-    if (reader_copy.keep_first != Reader::no_ and contains(single_QHD_found,invariant)) return;
+    STATS(stats.hits[Search_Stats::kind_QHD_single]++;)
+    const Invariant_Key key = Invariant_Key::single_QHD(current_K2,data.type,data.p,data.q,data.r);
+    if (keep_first != Reader::no_ and contains(single_QHD_found,key)) {
+        STATS(stats.repeated[Search_Stats::kind_QHD_single]++;)
+        return;
+    }
+#ifdef SHARE_FOUND_INVARIANTS
+    if (found_before(key)) {
+        STATS(stats.repeated[Search_Stats::kind_QHD_single]++;)
+        return;
+    }
+#endif
 
     // QHD found and not seen before.
     THREAD_STATIC std::vector<long long> discrepancies;
@@ -162,19 +178,21 @@ void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int ex
     long long n = algs::get_QHD_discrepancies(reduced_fork,reduced_self_int,data,discrepancies);
 
     pair<bool,bool> nef_result = {false,false};
-    if (reader_copy.nef_check != Reader::no_) {
+    if (check_now(reader.nef_check)) {
         nef_result = single_is_nef(reduced_self_int,discrepancies,n,extra_n,extra_orig,extra_pos,extra_id);
     }
-    if (reader_copy.nef_check == Reader::skip_ and !nef_result.first) {
+    if (reader.nef_check == Reader::skip_ and !nef_result.first) {
+        STATS(stats.not_nef[Search_Stats::kind_QHD_single]++;)
         return;
     }
 
     bool effective = false;
-    if (reader_copy.effective_check != Reader::no_) {
+    if (check_now(reader.effective_check)) {
         effective = single_is_effective(reduced_self_int,
             discrepancies,n);
     }
-    if (reader_copy.effective_check == Reader::skip_ and !effective) {
+    if (reader.effective_check == Reader::skip_ and !effective) {
+        STATS(stats.not_effective[Search_Stats::kind_QHD_single]++;)
         return;
     }
 
@@ -185,7 +203,7 @@ void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int ex
     example.K2 = current_K2;
     example.complete_fibers = current_complete_fibers;
     example.used_curves.insert(curve_translate.begin(),curve_translate.end());
-    for (int exceptional : reader_copy.K.used_components) {
+    for (int exceptional : reader.K.used_components) {
         if (temp_self_int[exceptional] == INT_MAX) {
             example.blown_down_exceptionals.insert(exceptional);
         }
@@ -201,6 +219,7 @@ void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int ex
     example.extra_n[0] = extra_n;
     example.extra_orig[0] = extra_orig;
     example.extra_pos[0] = extra_pos;
+    example.extra_border[0] = extra_id;
     example.chain[0].reserve(reduced_fork[0].size() + reduced_fork[1].size() + reduced_fork[2].size());
     for (int i = 0; i < 3; ++i) {
         example.chain[0].insert(example.chain[0].end(),reduced_fork[i].begin(),reduced_fork[i].end());
@@ -212,9 +231,12 @@ void Searcher::verify_QHD3_single_candidate(const vector<int> (&fork)[3], int ex
     example.nef_warning = nef_result.second;
     example.effective = effective;
 
-    results->push(std::move(example));
+    push_result(example);
 
-    if (reader_copy.keep_first != Reader::no_) {
-        single_QHD_found.insert(invariant);
+    if (keep_first != Reader::no_) {
+        single_QHD_found.insert(key);
     }
+#ifdef SHARE_FOUND_INVARIANTS
+    share_found(key);
+#endif
 }
@@ -435,6 +435,20 @@ bool safe_stoll(const string& s, long long& result) {
     return 1;
 }
 
+bool safe_stod(const string& s, double& result) {
+    try {
+        size_t z;
+        result = stod(s,&z);
+        if (z != s.size()) {
+            return 0;
+        }
+    }
+    catch (std::exception& e) {
+        return 0;
+    }
+    return 1;
+}
+
 Reader::Reader() {
     summary_style = plain_text_;
     summary_sort = sort_by_n_;
@@ -451,6 +465,7 @@ Reader::Reader() {
     search_double_QHD = false;
     summary_include_gcd = false;
     latex_include_subsection = false;
+    binary_output = false;
     line_no = 0;
     curve_no = 0;
     tests_no = 1;
@@ -459,6 +474,19 @@ Reader::Reader() {
     subtest_start = -1;
     subtest_end = -1;
     curves_used_exactly = -1;
+    slowest_tests = 0;
+    budget_separations = 0;
+    budget_candidates = 0;
+    budget_seconds = 0;
+    estimate = 0;
+    heuristic_order = false;
+    order_weights[0] = 0;
+    order_weights[1] = 0;
+    order_weights[2] = -1;
+    order_weights[3] = 1;
+    order_weights[4] = 1;
+    stop_after_examples = 0;
+    stop_after_seconds = 0;
     K.self_int = 0;
     fixed_curves.resize(1);
     try_curves.resize(1);
@@ -470,10 +498,12 @@ Reader::Reader() {
     output_filename = DEFAULT_OUTPUT_NAME;
     summary_filename = DEFAULT_SUMMARY_NAME;
     pretest_filename = DEFAULT_PRETEST_NAME;
+    pretest_input_filename = "";
     search_for.insert(1);
     search_for.insert(2);
     search_for.insert(3);
     search_for.insert(4);
+    search_targets = false;
     error_stream = &std::cerr;
 }
 
@@ -602,6 +632,11 @@ void Reader::parse(istream& input) {
         }
     }
 
+    adj_map.clear();
+    for (int i = 0; i < curve_no; ++i) {
+        adj_map.emplace_hint(adj_map.end(), i, adj_list[i]);
+    }
+
     // For consistency, sort all fixed / ignored / try vectors
     for (auto& v : fixed_curves) {
         std::sort(v.begin(),v.end());
@@ -632,6 +667,14 @@ void Reader::parse(istream& input) {
         tests_no = std::max(1,max_test_number - tests_start_index);
     }
 
+    if (search_targets) {
+        // Do not search for configurations that cannot give any target.
+        search_single_chain = search_single_chain and !target_wahl.empty();
+        search_double_chain = search_double_chain and (!target_wahl.empty() or !target_p_extremal.empty());
+        search_single_QHD = search_single_QHD and !target_QHD.empty();
+        search_double_QHD = search_double_QHD and !target_QHD.empty() and !target_wahl.empty();
+    }
+
     if (parse_only) {
         warning("Parse only debug mode: no testing is done.");
     }
@@ -728,6 +771,116 @@ void Reader::parse_option(const vector<string>& tokens) {
         pretest_filename = tokens[1];
         return;
     }
+    else if (tokens[0] == "Pretest_Input:") {
+        if (tokens.size() != 2) {
+            error("Option \'Pretest_Input\' must take exactly one argument.");
+        }
+        pretest_input_filename = tokens[1];
+        return;
+    }
+    else if (tokens[0] == "Slowest_Tests:") {
+        if (tokens.size() != 2) {
+            error("Option \'Slowest_Tests\' must take exactly one argument.");
+        }
+        int value;
+        if (!safe_stoi(tokens[1],value) or value < 0) {
+            error("Invalid number for option \'Slowest_Tests\': " + tokens[1]);
+        }
+        slowest_tests = value;
+        return;
+    }
+    else if (tokens[0] == "Budget_Separations:") {
+        if (tokens.size() != 2) {
+            error("Option \'Budget_Separations\' must take exactly one argument.");
+        }
+        long long value;
+        if (!safe_stoll(tokens[1],value) or value < 0) {
+            error("Invalid number for option \'Budget_Separations\': " + tokens[1]);
+        }
+        budget_separations = value;
+        return;
+    }
+    else if (tokens[0] == "Budget_Candidates:") {
+        if (tokens.size() != 2) {
+            error("Option \'Budget_Candidates\' must take exactly one argument.");
+        }
+        long long value;
+        if (!safe_stoll(tokens[1],value) or value < 0) {
+            error("Invalid number for option \'Budget_Candidates\': " + tokens[1]);
+        }
+        budget_candidates = value;
+        return;
+    }
+    else if (tokens[0] == "Budget_Seconds:") {
+        if (tokens.size() != 2) {
+            error("Option \'Budget_Seconds\' must take exactly one argument.");
+        }
+        double value;
+        if (!safe_stod(tokens[1],value) or !(value >= 0)) {
+            error("Invalid number for option \'Budget_Seconds\': " + tokens[1]);
+        }
+        budget_seconds = value;
+        return;
+    }
+    else if (tokens[0] == "Estimate:") {
+        if (tokens.size() != 2) {
+            error("Option \'Estimate\' must take exactly one argument.");
+        }
+        long long value;
+        if (!safe_stoll(tokens[1],value) or value < 0) {
+            error("Invalid number for option \'Estimate\': " + tokens[1]);
+        }
+        estimate = value;
+        return;
+    }
+    else if (tokens[0] == "Search_Order:") {
+        if (tokens.size() != 2) {
+            error("Option \'Search_Order\' must take exactly one argument.");
+        }
+        if (tokens[1] == "Natural") {
+            heuristic_order = false;
+        }
+        else if (tokens[1] == "Heuristic") {
+            heuristic_order = true;
+        }
+        else {
+            error("Invalid argument for \'Search_Order\': " + tokens[1]);
+        }
+        return;
+    }
+    else if (tokens[0] == "Order_Weights:") {
+        if (tokens.size() != 6) {
+            error("Option \'Order_Weights\' must take exactly five arguments.");
+        }
+        for (int i = 0; i < 5; ++i) {
+            if (!safe_stoll(tokens[i+1],order_weights[i])) {
+                error("Invalid number for option \'Order_Weights\': " + tokens[i+1]);
+            }
+        }
+        return;
+    }
+    else if (tokens[0] == "Stop_After_Examples:") {
+        if (tokens.size() != 2) {
+            error("Option \'Stop_After_Examples\' must take exactly one argument.");
+        }
+        long long value;
+        if (!safe_stoll(tokens[1],value) or value < 0) {
+            error("Invalid number for option \'Stop_After_Examples\': " + tokens[1]);
+        }
+        stop_after_examples = value;
+        return;
+    }
+    else if (tokens[0] == "Stop_After_Seconds:") {
+        if (tokens.size() != 2) {
+            error("Option \'Stop_After_Seconds\' must take exactly one argument.");
+        }
+        double value;
+        if (!safe_stod(tokens[1],value) or !(value >= 0)) {
+            error("Invalid number for option \'Stop_After_Seconds\': " + tokens[1]);
+        }
+        stop_after_seconds = value;
+        return;
+    }
     else if (tokens[0] == "Summary_Style:") {
         if (tokens.size() != 2) {
             error("Option \'Summary_Style\' must take exactly one argument.");
@@ -776,6 +929,21 @@ void Reader::parse_option(const vector<string>& tokens) {
         }
         return;
     }
+    else if (tokens[0] == "Binary_Output:") {
+        if (tokens.size() != 2) {
+            error("Option \'Binary_Output\' must take exactly one argument.");
+        }
+        if (tokens[1] == "Y") {
+            binary_output = true;
+        }
+        else if (tokens[1] == "N") {
+            binary_output = false;
+        }
+        else {
+            error("Invalid argument for \'Binary_Output\': " + tokens[1]);
+        }
+        return;
+    }
     else if (tokens[0] == "Summary_Sort:") {
         if (tokens.size() != 2) {
             error("Option \'Summary_Sort\' must take exactly one argument.");
@@ -919,6 +1087,55 @@ void Reader::parse_option(const vector<string>& tokens) {
         }
         return;
     }
+    else if (tokens[0] == "Target_Invariants:") {
+        if (tokens.size() < 2) {
+            error("Option \'Target_Invariants\' must take at least one argument.");
+        }
+        if (tokens[1] == "Wahl" or tokens[1] == "P_Extremal") {
+            if (tokens.size() != 4) {
+                error("Target \'" + tokens[1] + "\' must take exactly two numbers.");
+            }
+            long long n, a;
+            if (!safe_stoll(tokens[2],n) or n < 2) {
+                error("Invalid number for option \'Target_Invariants\': " + tokens[2]);
+            }
+            if (!safe_stoll(tokens[3],a) or a <= 0 or a >= n or algs::gcd(n,a) != 1) {
+                error("Invalid number for option \'Target_Invariants\': " + tokens[3]);
+            }
+            vector<int> chain;
+            if (tokens[1] == "Wahl") {
+                target_wahl.emplace(n,std::min(a,n-a));
+                algs::to_chain(n*n,n*a-1,chain);
+                target_wahl_lengths.insert(chain.size());
+            }
+            else {
+                target_p_extremal.emplace(n,std::min(a,algs::gcd_invmod(n,a).second));
+                algs::to_chain(n,a,chain);
+                target_p_extremal_lengths.insert(chain.size());
+            }
+        }
+        else if (tokens[1] == "QHD") {
+            if (tokens.size() != 6) {
+                error("Target \'QHD\' must take a type and three numbers.");
+            }
+            if (tokens[2].size() != 1 or tokens[2][0] < 'a' or tokens[2][0] > 'j') {
+                error("Invalid QHD type for option \'Target_Invariants\': " + tokens[2]);
+            }
+            int values[3];
+            for (int i = 0; i < 3; ++i) {
+                if (!safe_stoi(tokens[3+i],values[i])) {
+                    error("Invalid number for option \'Target_Invariants\': " + tokens[3+i]);
+                }
+            }
+            // Same numbering as algs::QHD_Type.
+            target_QHD.emplace(tokens[2][0] - 'a' + 1,values[0],values[1],values[2]);
+        }
+        else {
+            error("Invalid argument for \'Target_Invariants\': " + tokens[1]);
+        }
+        search_targets = true;
+        return;
+    }
     else if (tokens[0] == "K2:") {
         if (tokens.size() != 2) {
             error("Option \'K2\' must take exactly one argument.");
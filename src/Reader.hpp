@@ -6,6 +6,7 @@
 #include<set> // set, multiset
 #include<map> // map
 #include<string> // string
+#include<tuple> // tuple
 #include<unordered_set> // unordered_set
 #include<iostream> // istream, ostream
 
@@ -34,8 +35,16 @@ summary_include_gcd: if the example is with double chain, this determines if in
 
 latex_include_subsection: if the summary style is a latex table, this includes \subsection before each table.
 
+binary_output: wether to also export the examples to a binary columnar file, see Writer::Binary_Column.
+
 search_for: the K^2 we want to search for.
 
+search_targets: wether only examples whose singularities are in the target sets are searched for.
+
+target_wahl: uniformized (n,a) of the Wahl singularities we want. target_p_extremal: same with (Delta,Omega) of P-extremal resolutions. target_QHD: (type,p,q,r) of the QHD3 singularities.
+
+target_wahl_lengths, target_p_extremal_lengths: lengths of the chains of the targets, so that candidates are discarded before computing continued fractions.
+
 threads: number of threads to run.
 
 test_no: the number of different tests.
@@ -48,6 +57,18 @@ K: Canonical divisor that keeps track of exceptional curves
 
 output_filename, summary_filename: self explanatory. Doesn't include extension.
 
+pretest_filename: where the passed pretests are exported. pretest_input_filename: if not empty, a file of pretests as exported, and only those tests are searched.
+
+slowest_tests: how many of the sub-tests that took the longest to search are reported at the end. 0 for none.
+
+budget_separations, budget_candidates, budget_seconds: limits for the search of one sub-test, 0 for none. A sub-test that goes over one is left unfinished and written to the retry file.
+
+estimate: if positive, only a random sample of this many sub-tests is searched, and the results of the whole run are extrapolated from it.
+
+heuristic_order: wether the sub-tests that pass the pretest are searched by decreasing score instead of in order. order_weights: the weights of the score, see Searcher::score.
+
+stop_after_examples, stop_after_seconds: the search stops early after finding this many examples or after this many seconds, 0 for never.
+
 curve_id: dictionary which gives an id to a curve as in the input.
 
 curve_name: name of the curve with given id.
@@ -60,6 +81,8 @@ sections: self explanatory.
 
 adj_list: adjacency list of the dual graph.
 
+adj_map: adj_list as a map, built once after parsing. Searchers copy it into the graph of each sub-test.
+
 self_int: self intersection of the curves.
 
 fixed_curves: for every test t, fixed_curves[t] contains the curves fixed in that test.
@@ -137,7 +160,14 @@ public:
     bool search_double_QHD;
     bool summary_include_gcd;
     bool latex_include_subsection;
+    bool binary_output;
     std::set<int> search_for;
+    bool search_targets;
+    std::set<std::pair<long long,long long>> target_wahl;
+    std::set<std::pair<long long,long long>> target_p_extremal;
+    std::set<std::tuple<char,int,int,int>> target_QHD;
+    std::set<int> target_wahl_lengths;
+    std::set<int> target_p_extremal_lengths;
 
 #ifdef MULTITHREAD
     int threads;
@@ -149,6 +179,19 @@ public:
 
     int curves_used_exactly;
 
+    int slowest_tests;
+
+    long long budget_separations;
+    long long budget_candidates;
+    double budget_seconds;
+
+    long long estimate;
+
+    bool heuristic_order;
+    long long order_weights[5];
+    long long stop_after_examples;
+    double stop_after_seconds;
+
     long long subtest_start;
     long long subtest_end;
 
@@ -159,6 +202,7 @@ public:
     std::string output_filename;
     std::string summary_filename;
     std::string pretest_filename;
+    std::string pretest_input_filename;
     std::map<std::string,int> curve_id;
     std::vector<std::string> curve_name;
     std::vector<std::vector<int>> fibers;
@@ -167,6 +211,7 @@ public:
     std::unordered_set<int> forgotten_exceptionals;
     std::set<int> sections;
     std::vector<std::multiset<int>> adj_list;
+    std::map<int,std::multiset<int>> adj_map;
     std::vector<int> self_int;
     std::vector<std::vector<int>> fixed_curves;
     std::vector<std::vector<int>> try_curves;
@@ -0,0 +1,346 @@
+#include"Wahl.hpp"
+#include"Searcher.hpp" // Compact_Example, Example
+#include"Writer.hpp" // export_summary_text, export_summary_latex, Output_Buffer
+#include<fstream> // ifstream, ofstream
+#include<cstring> // memchr, strlen, memcmp
+#include<algorithm> // sort, binary_search
+
+#ifdef MULTITHREAD
+#include<thread> // thread
+#endif
+
+using std::vector;
+
+/*
+    Regenerates the summary (and the order of the jsonl file) from a jsonl file written by a previous search, without searching again.
+    Called as
+        Search.exe --reexport file.jsonl [config]
+    If a config file is given, its summary and output settings are used, and the checks keep the mode given there when the jsonl has them.
+    Otherwise the settings are the defaults, the jsonl file is rewritten in place and every check in the jsonl is printed.
+
+    Only the fields used by the summary and the sort are read from each example, the rest of the line is skipped.
+    The line index replaces the test number to break ties when sorting. This gives the same order as the search:
+    examples with the same sort key in one order also had the same key in the other, so the file already has them sorted by test.
+*/
+
+// Walks over the keys of one line of a jsonl file, as written by Writer.
+// Values that are not asked for are skipped without being parsed.
+class Json_Line {
+public:
+    Json_Line(const char* begin, const char* end) : ptr(begin), end(end) {}
+
+    // Moves to the next key. Returns false at the end of the object.
+    bool next_key(const char*& key, size_t& length) {
+        while (ptr < end and *ptr != '\"') {
+            if (*ptr == '}') return false;
+            ++ptr;
+        }
+        if (ptr >= end) return false;
+        key = ++ptr;
+        while (ptr < end and *ptr != '\"') ++ptr;
+        length = ptr - key;
+        ptr += 2; // "\":"
+        return ptr < end;
+    }
+
+    long long number() {
+        bool negative = (*ptr == '-');
+        if (negative) ++ptr;
+        long long x = 0;
+        while (ptr < end and *ptr >= '0' and *ptr <= '9') x = 10*x + (*ptr++ - '0');
+        return negative ? -x : x;
+    }
+
+    bool boolean() {
+        bool value = (*ptr == 't');
+        skip();
+        return value;
+    }
+
+    char character() {
+        char value = ptr[1];
+        skip();
+        return value;
+    }
+
+    // Reads an array of numbers.
+    template<typename T>
+    void array(vector<T>& values) {
+        values.clear();
+        ++ptr; // [
+        while (ptr < end and *ptr != ']') {
+            values.push_back(number());
+            if (*ptr == ',') ++ptr;
+        }
+        ++ptr; // ]
+    }
+
+    // Reads an array of arrays of numbers.
+    void array_of_arrays(vector<vector<int>>& values) {
+        values.clear();
+        ++ptr; // [
+        while (ptr < end and *ptr != ']') {
+            values.emplace_back();
+            array(values.back());
+            if (*ptr == ',') ++ptr;
+        }
+        ++ptr; // ]
+    }
+
+    // Skips one value of any kind.
+    void skip() {
+        int depth = 0;
+        for (; ptr < end; ++ptr) {
+            char c = *ptr;
+            if (c == '\"') {
+                ++ptr;
+                while (ptr < end and *ptr != '\"') ++ptr;
+            }
+            else if (c == '[' or c == '{') ++depth;
+            else if (c == ']' or c == '}') {
+                if (depth == 0) return;
+                if (--depth == 0) {
+                    ++ptr;
+                    return;
+                }
+            }
+            else if (c == ',' and depth == 0) return;
+        }
+    }
+
+    const char* ptr;
+    const char* end;
+};
+
+static inline bool key_is(const char* key, size_t length, const char* name) {
+    return length == std::strlen(name) and std::memcmp(key, name, length) == 0;
+}
+
+// Reads what the summary needs from one example. fibers is only used if need_used is set, to count the complete fibers.
+static void read_example(const char* begin, const char* end, bool need_used, const vector<vector<int>>& fibers,
+        Compact_Example& ex, vector<long long>& values, vector<int>& used) {
+    Json_Line line(begin, end);
+    ex = Compact_Example();
+    ex.data = nullptr;
+    int chains = 1;
+    int worm_hole = 0;
+    char qhd_type = 0;
+    long long first_curve[2] = {-1,-1};
+    bool has_used = false;
+
+    const char* key;
+    size_t length;
+    while (line.next_key(key, length)) {
+        if (key_is(key, length, "#")) chains = line.number();
+        else if (key_is(key, length, "WH")) worm_hole = line.number();
+        else if (key_is(key, length, "WHid")) ex.worm_hole_id = line.number();
+        else if (key_is(key, length, "K2")) ex.K2 = line.number();
+        else if (key_is(key, length, "N") or key_is(key, length, "N0")) ex.n[0] = line.number();
+        else if (key_is(key, length, "N1")) ex.n[1] = line.number();
+        else if (key_is(key, length, "p")) ex.p = line.number();
+        else if (key_is(key, length, "q")) ex.q = line.number();
+        else if (key_is(key, length, "r")) ex.r = line.number();
+        else if (key_is(key, length, "type")) qhd_type = line.character();
+        else if (key_is(key, length, "chain") or key_is(key, length, "chain0") or key_is(key, length, "chain1") or key_is(key, length, "fork")) {
+            // chain is the only chain of single examples, and the second one of QHD double examples.
+            int i = (key_is(key, length, "chain1") or (key_is(key, length, "chain") and chains == 2)) ? 1 : 0;
+            line.array(values);
+            ex.length[i] = values.size();
+            if (!values.empty() and !key_is(key, length, "fork")) first_curve[i] = values[0];
+        }
+        else if (key_is(key, length, "disc")) {
+            // The discrepancy of the first curve of a Wahl chain of (n,a) is a - n.
+            line.array(values);
+            for (int i = 0; i < 2; ++i) {
+                if (first_curve[i] >= 0) ex.a[i] = ex.n[i] + values[first_curve[i]];
+            }
+        }
+        else if (need_used and key_is(key, length, "used")) {
+            line.array(used);
+            has_used = true;
+        }
+        else if (key_is(key, length, "WH_CE")) ex.worm_hole_conjecture_counterexample = line.boolean();
+        else if (key_is(key, length, "nef")) ex.nef = line.boolean();
+        else if (key_is(key, length, "nef_warn")) ex.nef_warning = line.boolean();
+        else if (key_is(key, length, "obs")) ex.no_obstruction = line.boolean();
+        else if (key_is(key, length, "Qef")) ex.effective = line.boolean();
+        else line.skip();
+    }
+
+    if (chains == 1) {
+        ex.type = qhd_type ? (Example::Type)(Example::QHD_single_a_ + qhd_type - 'a') : Example::single_;
+    }
+    else if (qhd_type) {
+        // Partial QHD examples are written as double QHD ones.
+        ex.type = (Example::Type)(Example::QHD_double_a_ + qhd_type - 'a');
+    }
+    else {
+        ex.type = worm_hole ? Example::p_extremal_ : Example::double_;
+        ex.worm_hole = (worm_hole == 2);
+    }
+
+    // A fiber is complete if all its curves are used, as in Searcher::check_obstruction.
+    if (has_used) {
+        std::sort(used.begin(), used.end());
+        for (const vector<int>& fiber : fibers) {
+            bool is_complete = true;
+            for (int curve : fiber) {
+                if (!std::binary_search(used.begin(), used.end(), curve)) {
+                    is_complete = false;
+                    break;
+                }
+            }
+            if (is_complete) ++ex.complete_fibers;
+        }
+    }
+}
+
+void Wahl::reexport(int argc, char** argv) {
+    if (argc < 3) {
+        std::cout << "Usage: " << argv[0] << " --reexport <jsonl file> [config]" << std::endl;
+        return;
+    }
+    std::string input_filename = argv[2];
+    std::ifstream f(input_filename, std::ios::binary);
+    if (f.fail()) {
+        std::cout << "Error while opening file \"" << input_filename << "\". (Does it exist?)." << std::endl;
+        return;
+    }
+    // The whole file is kept in memory, so the output may be the same file.
+    std::string file((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    f.close();
+
+    if (argc > 3) {
+        std::ifstream config(argv[3]);
+        if (config.fail()) {
+            std::cout << "Error while opening file \"" << argv[3] << "\". (Does it exist?)." << std::endl;
+            return;
+        }
+        reader.parse(config);
+        config.close();
+    }
+    else {
+        reader.output_filename = input_filename;
+        if (reader.output_filename.size() > 6 and reader.output_filename.substr(reader.output_filename.size() - 6) == ".jsonl") {
+            reader.output_filename.resize(reader.output_filename.size() - 6);
+        }
+        reader.nef_check = reader.effective_check = reader.obstruction_check = Reader::print_;
+    }
+
+    // Line i + 1 is the example with index i.
+    vector<size_t> line_start = {0};
+    for (size_t position = 0; position < file.size();) {
+        const char* next = static_cast<const char*>(std::memchr(file.data() + position, '\n', file.size() - position));
+        position = next ? next - file.data() + 1 : file.size();
+        line_start.push_back(position);
+    }
+    if (line_start.size() < 2) {
+        std::cout << "The file \"" << input_filename << "\" is empty." << std::endl;
+        return;
+    }
+
+    // The checks not done in the search are not in the file.
+    vector<vector<int>> fibers;
+    {
+        Json_Line graph(file.data(), file.data() + line_start[1]);
+        const char* key;
+        size_t length;
+        while (graph.next_key(key, length)) {
+            if (key_is(key, length, "Fibers")) graph.array_of_arrays(fibers);
+            else if (key_is(key, length, "nef_check")) {
+                if (!graph.boolean()) reader.nef_check = Reader::no_;
+            }
+            else if (key_is(key, length, "effective_check")) {
+                if (!graph.boolean()) reader.effective_check = Reader::no_;
+            }
+            else if (key_is(key, length, "obstruction_check")) {
+                if (!graph.boolean()) reader.obstruction_check = Reader::no_;
+            }
+            else graph.skip();
+        }
+    }
+    const bool need_used = (reader.obstruction_check == Reader::print_);
+
+    const size_t size = line_start.size() - 2;
+    vector<Compact_Example> example_vector(size);
+    auto read_range = [&] (size_t start, size_t end) {
+        vector<long long> values;
+        vector<int> used;
+        for (size_t i = start; i < end; ++i) {
+            read_example(file.data() + line_start[i+1], file.data() + line_start[i+2], need_used, fibers, example_vector[i], values, used);
+            example_vector[i].test = i;
+        }
+    };
+#ifdef MULTITHREAD
+    write_threads = reader.threads;
+    const size_t range = std::max((size_t)1, (size + reader.threads - 1)/reader.threads);
+    vector<std::thread> spawns;
+    for (size_t start = 0; start < size; start += range) {
+        spawns.emplace_back(read_range, start, std::min(start + range, size));
+    }
+    for (auto& spawn : spawns) {
+        spawn.join();
+    }
+#else
+    read_range(0,size);
+#endif
+    std::cout << "Read " << size << " examples." << std::endl;
+
+    vector<Compact_Example*> ptr_example_vector;
+    sort_examples(example_vector, ptr_example_vector);
+    for (size_t i = 0; i < size; ++i) {
+        ptr_example_vector[i]->export_id = i;
+    }
+    // Worm holes keep their partner, which now may have a different index.
+    for (Compact_Example& ex : example_vector) {
+        if (ex.type == Example::p_extremal_ and ex.worm_hole and !ex.worm_hole_conjecture_counterexample) {
+            ex.worm_hole_id = example_vector[ex.worm_hole_id].export_id;
+        }
+    }
+
+    // Write the lines in the new order. Only the index of the partner of a worm hole changes.
+    std::string filename = reader.output_filename + ".jsonl";
+    std::ofstream g(filename, std::ios::binary);
+    if (g.fail()) {
+        std::cout << "Error while opening file \"" << filename << "\". Aborting jsonl export." << std::endl;
+    }
+    else {
+        vector<unsigned long long> offsets;
+        offsets.reserve(size + 2);
+        offsets.push_back(0);
+        Writer::Output_Buffer buffer;
+        unsigned long long position = 0;
+        buffer << std::string(file.data(), line_start[1]);
+        for (Compact_Example* ptr : ptr_example_vector) {
+            const Compact_Example& ex = *ptr;
+            position += buffer.size();
+            buffer.write_to(g);
+            offsets.push_back(position);
+            const char* begin = file.data() + line_start[ex.test + 1];
+            const char* end = file.data() + line_start[ex.test + 2];
+            if (ex.type == Example::p_extremal_ and ex.worm_hole and !ex.worm_hole_conjecture_counterexample) {
+                const char* id = std::strstr(begin, "\"WHid\":") + 7;
+                const char* id_end = id;
+                while (*id_end >= '0' and *id_end <= '9') ++id_end;
+                buffer << std::string(begin, id) << ex.worm_hole_id << std::string(id_end, end);
+            }
+            else {
+                buffer << std::string(begin, end);
+            }
+        }
+        position += buffer.size();
+        buffer.write_to(g);
+        offsets.push_back(position);
+        g.close();
+#ifdef EXPORT_JSONL_INDEX
+        Writer::export_jsonl_index(filename + ".idx", ptr_example_vector, offsets);
+#endif
+    }
+
+    if (reader.summary_style == Reader::plain_text_) {
+        Writer::export_summary_text(reader,ptr_example_vector);
+    }
+    else if (reader.summary_style == Reader::latex_table_) {
+        Writer::export_summary_latex(reader,ptr_example_vector);
+    }
+}
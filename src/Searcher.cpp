@@ -1,44 +1,207 @@
 #include"Searcher.hpp"
 #include"Wahl.hpp" // sigint_catched
-#include"Algorithms.hpp" // algs::ith_combination
+#include"Algorithms.hpp" // algs::ith_combination, algs::put_varint, algs::get_varint
 #include<climits> // INT_MAX
+#include<algorithm> // copy
 
-#if !defined(MULTITHREAD) && defined(PRINT_STATUS)
 #include<chrono> // steady_clock, milliseconds
-#endif
 
 void Searcher_Wrapper::search() {
-    Searcher worker;
+    Searcher worker(parent->reader);
     worker.parent = parent;
-    worker.reader_copy = parent->reader;
     worker.results = &results;
+    worker.arena = &arena;
+    worker.slowest_tests = &slowest_tests;
+    worker.suspended_tests = &suspended_tests;
+    if (parent->reader.estimate > 0) worker.estimate_samples = &estimate_samples;
+    if (scoring) worker.scores = &scores;
+    // The first example of each sub-test is kept by Wahl::merge_first_found instead, see Wahl::merge_at_end.
+    if (parent->merge_at_end) worker.keep_first = Reader::keep_local_;
     worker.err = &err;
     worker.wrapper_current_test = &current_test;
     #ifdef EXPORT_PRETEST_DATA
         worker.passed_pretest_list = &passed_pretest_list;
+        if (parent->reader.export_pretests != Reader::no_ and !scoring and !passed_pretest_list.open(parent->reader.pretest_filename + ".part" + std::to_string(id))) {
+            std::cout << "Error while opening file \"" << passed_pretest_list.filename << "\". Pretests of this thread are not exported." << std::endl;
+        }
     #endif
     #if defined(PRINT_PASSED_PRETESTS_END) || defined(PRINT_STATUS_EXTRA)
         worker.wrapper_passed_pretests = &passed_pretests;
         passed_pretests = 0;
     #endif
+    #ifdef PRINT_PASSED_PRETESTS_END
+        worker.passed_pretest_positions = parent->reader.stop_after_examples > 0 ? &passed_pretest_positions : nullptr;
+    #endif
+    worker.count_distinct = parent->merge_at_end and parent->reader.stop_after_examples > 0;
     #ifdef PRINT_STATUS_EXTRA
         worker.wrapper_total_examples = &total_examples;
         total_examples = 0;
     #endif
+    #ifdef SEARCH_STATS
+        worker.wrapper_stats = &stats;
+        #ifdef MULTITHREAD
+            worker.wrapper_stats_mutex = &stats_mutex;
+        #endif
+    #endif
 
     worker.search();
+    STATS(worker.publish_stats();)
 }
 
 
-void Searcher::init() {
-    const int s = reader_copy.curve_no;
-    for (int i = 0; i < s; ++i) {
-        original_adj_map[i] = reader_copy.adj_list[i];
+Compact_Example::Compact_Example(const Example& example, Example_Arena& arena) :
+    test(example.test),
+    n{example.n[0],example.n[1]},
+    a{example.a[0],example.a[1]},
+    Delta(example.Delta),
+    Omega(example.Omega),
+    export_id(example.export_id),
+    K2(example.K2),
+    complete_fibers(example.complete_fibers),
+    p(example.p),
+    q(example.q),
+    r(example.r),
+    worm_hole_id(example.worm_hole_id),
+    length{(int)example.chain[0].size(),(int)example.chain[1].size()},
+    type(example.type),
+    worm_hole(example.worm_hole),
+    worm_hole_conjecture_counterexample(example.worm_hole_conjecture_counterexample),
+    no_obstruction(example.no_obstruction),
+    nef(example.nef),
+    nef_warning(example.nef_warning),
+    effective(example.effective)
+{
+    THREAD_STATIC std::vector<unsigned char> bytes;
+    bytes.clear();
+    auto put = [&] (long long x) {
+        algs::put_varint(bytes,algs::zigzag(x));
+    };
+    // Sets are sorted, so write the differences between consecutive curves.
+    auto put_set = [&] (const std::set<int>& S) {
+        algs::put_varint(bytes,S.size());
+        int previous = 0;
+        for (int curve : S) {
+            put(curve - previous);
+            previous = curve;
+        }
+    };
+    auto put_vector = [&] (const auto& v, bool with_size) {
+        if (with_size) algs::put_varint(bytes,v.size());
+        for (auto x : v) put(x);
+    };
+
+    put_set(example.used_curves);
+    put_set(example.blown_down_exceptionals);
+    algs::put_varint(bytes,example.blowups.size());
+    for (auto& blowup : example.blowups) {
+        put(blowup.first);
+        put(blowup.second);
+    }
+    for (int i = 0; i < 2; ++i) {
+        put(example.extra_n[i]);
+        put(example.extra_orig[i]);
+        put(example.extra_pos[i]);
+        put(example.extra_border[i]);
+    }
+    // The sizes of the chains are kept in length.
+    put_vector(example.chain[0],false);
+    put_vector(example.chain[1],false);
+    put_vector(example.self_int,true);
+    put_vector(example.discrepancies,true);
+
+    // Data only some types have.
+    if (example.type == Example::p_extremal_) {
+        put_vector(example.chain_original,true);
+        put_vector(example.self_int_original,true);
     }
+    else if (example.type != Example::single_ and example.type != Example::double_) {
+        for (int i = 0; i < 3; ++i) put(example.branch_permutation[i]);
+    }
+
+    unsigned char* memory = arena.allocate(bytes.size());
+    std::copy(bytes.begin(),bytes.end(),memory);
+    data = memory;
+}
+
+void Compact_Example::expand(Example& example) const {
+    example.export_id = export_id;
+    example.test = test;
+    example.type = type;
+    example.K2 = K2;
+    example.complete_fibers = complete_fibers;
+    example.n[0] = n[0];
+    example.n[1] = n[1];
+    example.a[0] = a[0];
+    example.a[1] = a[1];
+    example.p = p;
+    example.q = q;
+    example.r = r;
+    example.Delta = Delta;
+    example.Omega = Omega;
+    example.worm_hole = worm_hole;
+    example.worm_hole_id = worm_hole_id;
+    example.worm_hole_conjecture_counterexample = worm_hole_conjecture_counterexample;
+    example.no_obstruction = no_obstruction;
+    example.nef = nef;
+    example.nef_warning = nef_warning;
+    example.effective = effective;
+
+    const unsigned char* ptr = data;
+    auto get = [&ptr] () -> long long {
+        return algs::unzigzag(algs::get_varint(ptr));
+    };
+    auto get_set = [&] (std::set<int>& S) {
+        S.clear();
+        size_t size = algs::get_varint(ptr);
+        int curve = 0;
+        for (size_t i = 0; i < size; ++i) {
+            curve += get();
+            S.insert(S.end(),curve);
+        }
+    };
+    auto get_vector = [&] (auto& v, size_t size) {
+        v.resize(size);
+        for (auto& x : v) x = get();
+    };
+
+    get_set(example.used_curves);
+    get_set(example.blown_down_exceptionals);
+    example.blowups.resize(algs::get_varint(ptr));
+    for (auto& blowup : example.blowups) {
+        blowup.first = get();
+        blowup.second = get();
+    }
+    for (int i = 0; i < 2; ++i) {
+        example.extra_n[i] = get();
+        example.extra_orig[i] = get();
+        example.extra_pos[i] = get();
+        example.extra_border[i] = get();
+    }
+    get_vector(example.chain[0],length[0]);
+    get_vector(example.chain[1],length[1]);
+    get_vector(example.self_int,algs::get_varint(ptr));
+    get_vector(example.discrepancies,algs::get_varint(ptr));
+
+    example.chain_original.clear();
+    example.self_int_original.clear();
+    if (type == Example::p_extremal_) {
+        get_vector(example.chain_original,algs::get_varint(ptr));
+        get_vector(example.self_int_original,algs::get_varint(ptr));
+    }
+    else if (type != Example::single_ and type != Example::double_) {
+        for (int i = 0; i < 3; ++i) example.branch_permutation[i] = get();
+    }
+}
+
+void Searcher::init() {
+    const int s = reader.curve_no;
     temp_try_included_exceptional.assign(s,-1);
     temp_marked_exceptional.assign(s,-1);
+    temp_ignored_stamp.assign(s,0);
+    contraction_stamp = 0;
     current_complete_fibers = 0;
     current_no_obstruction = false;
+    use_budget = reader.budget_separations > 0 or reader.budget_candidates > 0 or reader.budget_seconds > 0;
 }
 
 
@@ -64,7 +227,13 @@ bool Searcher::contract_exceptional() {
          If there are two different other curves and no parent is included, contract but mark both parents.
          Otherwise don't contract.
     */
-    for (auto canon_iter = reader_copy.K.components.rbegin(); canon_iter != reader_copy.K.components.rend(); ++canon_iter) {
+    contraction_stamp++;
+    for (int curve : temp_ignored_exceptional) {
+        temp_ignored_stamp[curve] = contraction_stamp;
+    }
+    auto ignored = [this] (int curve) { return temp_ignored_stamp[curve] == contraction_stamp; };
+
+    for (auto canon_iter = reader.K.components.rbegin(); canon_iter != reader.K.components.rend(); ++canon_iter) {
         const auto& comp = *canon_iter;
         if (temp_self_int[comp.id] != -1 or temp_marked_exceptional[comp.id] == current_test) continue;
 
@@ -146,7 +315,7 @@ bool Searcher::contract_exceptional() {
                 continue;
             }
             case 3: {
-                if(!contains(temp_ignored_exceptional,comp.left_parent)) {
+                if(!ignored(comp.left_parent)) {
                     continue;
                 }
                 auto iter = iter_excep->second.begin();
@@ -196,7 +365,7 @@ bool Searcher::contract_exceptional() {
                 continue;
             }
             case 3: {
-                if (!contains(temp_ignored_exceptional,comp.left_parent) and !contains(temp_ignored_exceptional,comp.right_parent)) {
+                if (!ignored(comp.left_parent) and !ignored(comp.right_parent)) {
                     continue;
                 }
                 if(temp_try_included_exceptional[comp.id] == current_test) {
@@ -208,10 +377,10 @@ bool Searcher::contract_exceptional() {
 
                 temp_included_curves[curve].erase(comp.id);
                 temp_self_int[curve]++;
-                if (!contains(temp_ignored_exceptional,comp.left_parent)) {
+                if (!ignored(comp.left_parent)) {
                     temp_marked_exceptional[comp.right_parent] = current_test;
                 }
-                else if (!contains(temp_ignored_exceptional,comp.right_parent)) {
+                else if (!ignored(comp.right_parent)) {
                     temp_marked_exceptional[comp.left_parent] = current_test;
                 }
                 temp_included_curves[comp.left_parent].erase(comp.id);
@@ -227,7 +396,7 @@ bool Searcher::contract_exceptional() {
                 continue;
             }
             case 4: {
-                if (!contains(temp_ignored_exceptional,comp.left_parent) or !contains(temp_ignored_exceptional,comp.right_parent)) {
+                if (!ignored(comp.left_parent) or !ignored(comp.right_parent)) {
                     continue;
                 }
                 auto iter = iter_excep->second.begin();
@@ -287,44 +456,28 @@ void Searcher::search() {
 #ifdef PRINT_STATUS_EXTRA
             std::cout << " PPT: " << *wrapper_passed_pretests << " Ex: " << *wrapper_total_examples;
 #endif //PRINT_STATUS_EXTRA
+#ifdef SEARCH_STATS
+            std::cout << " Sep: " << stats.separations << " Hits: " << stats.total_hits();
+#endif //SEARCH_STATS
 
             std::cout.flush();
             last_time = this_time;
         }
 #endif
+        finish_sample();
+        parent->check_stop();
         *wrapper_current_test = current_test = parent->get_test(current_test);
 
-        long long real_test = current_test + reader_copy.subtest_start;
-        if (current_test >= parent->total_tests) {
+        if (current_test >= parent->total_tests or current_test >= parent->stop_at) {
             return;
         }
-        while (parent->number_tests[test_index] + test_start <= real_test) {
-            test_start += parent->number_tests[test_index];
-            test_index++;
-        }
-        //from this mask read in order first try_curves and then choose_curves
-        long long mask = real_test - test_start;
+        long long real_test = parent->real_test(current_test);
 
-        K2 = reader_copy.K.self_int;
-
-        if (reader_copy.curves_used_exactly == -1) {
-            get_curves_from_mask(mask);
-        }
-        else {
-            bool ignore_test = get_curves_from_mask_exact_curves(mask);
-            if (ignore_test) continue;
-        }
-
-        bool ignore_test = contract_exceptional();
-        if(ignore_test) continue;
-
-        for (int ignored_ex : temp_ignored_exceptional) {
-            auto iter = temp_included_curves.find(ignored_ex);
-            if (iter == temp_included_curves.end()) continue;
-            for (int i : iter->second) {
-                temp_included_curves[i].erase(ignored_ex);
-            }
-        }
+        STATS(stats.start();)
+        if (estimate_samples) sample_begin = std::chrono::steady_clock::now();
+        bool ignore_test = load_test();
+        if (estimate_samples) estimate_samples->push_back({current_test, test_index, false, -1});
+        if (ignore_test) continue;
 
         int sum_self_int = 0;
         int double_singularities = 0;
@@ -335,63 +488,66 @@ void Searcher::search() {
             double_singularities += curve_data.second.size();
             curve_number++;
         }
+        STATS(stats.lap(Search_Stats::stage_pretest);)
         // P is the amount of Wahl chains that can be extracted from this example
         int P = sum_self_int + 5*curve_number - double_singularities;
 
-        if (!(P == 1 and (reader_copy.search_single_chain or reader_copy.search_single_QHD)) and
-            !(P == 2 and (reader_copy.search_double_chain or reader_copy.search_double_QHD))) continue;
+        if (!(P == 1 and (reader.search_single_chain or reader.search_single_QHD)) and
+            !(P == 2 and (reader.search_double_chain or reader.search_double_QHD))) continue;
 
         // K is the K^2 of the resulting X
         int K = K2 - 3*curve_number - sum_self_int + double_singularities/2;
         current_K2 = K;
 
-        if (!contains(reader_copy.search_for,K)) continue;
+        if (!contains(reader.search_for,K)) continue;
+        if (scores) {
+            scores->emplace_back(score(P,K,curve_number), real_test);
+            continue;
+        }
+        STATS(stats.passed_pretests++;)
+        if (estimate_samples) estimate_samples->back().passed_pretest = true;
 
         // Pretest passed.
         #ifdef PRINT_PASSED_PRETESTS_END
         (*wrapper_passed_pretests)++;
+        if (passed_pretest_positions) passed_pretest_positions->push_back(current_test);
         #endif
 
         #ifdef EXPORT_PRETEST_DATA
-        if (passed_pretest_list->size() < MAX_PRETEST_EXPORTED) {
+        if (reader.export_pretests != Reader::no_) {
             passed_pretest_list->push(real_test);
         }
-        if (reader_copy.export_pretests == Reader::only_) continue;
+        if (reader.export_pretests == Reader::only_) continue;
         #endif
 
-        G.reset();
-        curve_dict.clear();
-        curve_translate.resize(0);
-        ex_number = 0;
+        if (reader.slowest_tests > 0 or reader.budget_seconds > 0) test_begin = std::chrono::steady_clock::now();
+        separations = 0;
+        candidates = 0;
+        suspended = false;
+        clock_countdown = 0;
+        const size_t results_before = results->size();
 
-        for (auto& curve_data : temp_included_curves) {
-            if (contains(temp_ignored_exceptional, curve_data.first)) continue;
-            const int curve = curve_data.first;
-            curve_dict[curve] = ex_number;
-            curve_translate.emplace_back(curve);
-            G.add_curve(temp_self_int[curve]);
-            for (int other : curve_data.second) {
-                if (other > curve) break;
-                G.add_edge(curve_dict[other],ex_number);
-            }
-            ex_number++;
-        }
+        build_graph();
+        STATS(stats.lap(Search_Stats::stage_build_graph);)
 
-        if (reader_copy.obstruction_check != Reader::no_) {
+        if (check_now(reader.obstruction_check)) {
             auto obstruction_test = check_obstruction();
             current_no_obstruction = obstruction_test.first;
-            if (!current_no_obstruction and reader_copy.obstruction_check == Reader::skip_) {
+            STATS(stats.lap(Search_Stats::stage_obstruction);)
+            if (!current_no_obstruction and reader.obstruction_check == Reader::skip_) {
+                STATS(stats.obstructed++;)
+                STATS(publish_stats();)
                 continue;
             }
             current_complete_fibers = obstruction_test.second;
         }
 
         if (P == 1) {
-            if (reader_copy.keep_first == Reader::keep_local_) {
+            if (keep_first == Reader::keep_local_) {
                 single_found.clear();
                 single_QHD_found.clear();
             }
-            if (reader_copy.search_single_QHD) search_for_QHD3_single_chain();
+            if (reader.search_single_QHD) search_for_QHD3_single_chain();
             else search_for_single_chain();
 #ifdef PRINT_STATUS_EXTRA
             if (results->size() != *wrapper_total_examples) {
@@ -400,12 +556,12 @@ void Searcher::search() {
 #endif //PRINT_STATUS_EXTRA
         }
         else if (P == 2) {
-            if (reader_copy.keep_first == Reader::keep_local_) {
+            if (keep_first == Reader::keep_local_) {
                 double_found.clear();
                 P_extremal_found.clear();
                 double_QHD_found.clear();
             }
-            if (reader_copy.search_double_QHD) search_for_QHD3_double_chain();
+            if (reader.search_double_QHD) search_for_QHD3_double_chain();
             else search_for_double_chain();
 #ifdef PRINT_STATUS_EXTRA
             if (results->size() != *wrapper_total_examples) {
@@ -413,8 +569,193 @@ void Searcher::search() {
             }
 #endif //PRINT_STATUS_EXTRA
         }
+        STATS(stats.lap(Search_Stats::stage_search);)
+        STATS(stats.separations += separations;)
+        STATS(publish_stats();)
+
+        if (suspended) suspended_tests->push_back(real_test);
+        if (reader.stop_after_examples > 0 and !count_distinct) parent->found_examples += results->size() - results_before;
+
+        if (reader.slowest_tests > 0) {
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - test_begin).count();
+            if (slowest_tests->size() < (size_t) reader.slowest_tests or seconds > slowest_tests->top().seconds) {
+                if (slowest_tests->size() == (size_t) reader.slowest_tests) slowest_tests->pop();
+                slowest_tests->push({
+                    seconds,
+                    current_test + reader.subtest_start,
+                    real_test,
+                    reader.tests_start_index + test_index + 1,
+                    real_test - test_start,
+                    G.size,
+                    separations,
+                    candidates
+                });
+            }
+        }
+    }
+}
+
+long long Searcher::score(int P, int K, int curve_number) const {
+    int high_degree = 0;
+    for (auto& curve_data : temp_included_curves) {
+        if (contains(temp_ignored_exceptional, curve_data.first)) continue;
+        if (curve_data.second.size() >= 3) high_degree++;
+    }
+    int complete_fibers = 0;
+    for (auto& f : reader.fibers) {
+        bool is_complete = true;
+        for (int curve : f) {
+            if (!contains(temp_included_curves,curve)) {
+                is_complete = false;
+                break;
+            }
+        }
+        if (is_complete) {
+            ++complete_fibers;
+        }
+    }
+    const long long* w = reader.order_weights;
+    return w[0]*P + w[1]*K + w[2]*curve_number + w[3]*high_degree + w[4]*complete_fibers;
+}
+
+bool Searcher::load_test() {
+    long long real_test = parent->real_test(current_test);
+
+    // Tests only come in increasing order while searching. Deferred checks may go back.
+    if (real_test < test_start) {
+        test_index = 0;
+        test_start = 0;
+    }
+    while (parent->number_tests[test_index] + test_start <= real_test) {
+        test_start += parent->number_tests[test_index];
+        test_index++;
+    }
+    //from this mask read in order first try_curves and then choose_curves
+    long long mask = real_test - test_start;
+
+    K2 = reader.K.self_int;
+    STATS(stats.tests++;)
+
+    if (reader.curves_used_exactly == -1) {
+        get_curves_from_mask(mask);
+        STATS(stats.lap(Search_Stats::stage_get_curves);)
     }
+    else {
+        bool ignore_test = get_curves_from_mask_exact_curves(mask);
+        STATS(stats.lap(Search_Stats::stage_get_curves);)
+        STATS(stats.ignored_tests += ignore_test;)
+        if (ignore_test) return true;
+    }
+
+    bool ignore_test = contract_exceptional();
+    STATS(stats.lap(Search_Stats::stage_contract_exceptional);)
+    STATS(stats.ignored_tests += ignore_test;)
+    if (ignore_test) return true;
+
+    for (int ignored_ex : temp_ignored_exceptional) {
+        auto iter = temp_included_curves.find(ignored_ex);
+        if (iter == temp_included_curves.end()) continue;
+        for (int i : iter->second) {
+            temp_included_curves[i].erase(ignored_ex);
+        }
+    }
+    return false;
+}
+
+void Searcher::build_graph() {
+    G.reset();
+    curve_dict.clear();
+    curve_translate.resize(0);
+    ex_number = 0;
+
+    for (auto& curve_data : temp_included_curves) {
+        if (contains(temp_ignored_exceptional, curve_data.first)) continue;
+        const int curve = curve_data.first;
+        curve_dict[curve] = ex_number;
+        curve_translate.emplace_back(curve);
+        G.add_curve(temp_self_int[curve]);
+        for (int other : curve_data.second) {
+            if (other > curve) break;
+            G.add_edge(curve_dict[other],ex_number);
+        }
+        ex_number++;
+    }
+}
+
+void Searcher::count_result() {
+    parent->count_distinct(results->back());
+}
+
+#ifdef SHARE_FOUND_INVARIANTS
+bool Searcher::found_before(const Invariant_Key& key) const {
+    if (keep_first != Reader::keep_global_) return false;
+    return parent->shared_found.first_test(key) < current_test;
+}
+
+void Searcher::share_found(const Invariant_Key& key) {
+    if (keep_first != Reader::keep_global_) return;
+    parent->shared_found.update(key,current_test);
+}
+#endif
+
+#ifdef DEFER_PRINT_CHECKS
+void Searcher::deferred_checks(Compact_Example& compact_example) {
+    if (compact_example.test != current_test) {
+        current_test = compact_example.test;
+        load_test();
+        build_graph();
+        if (reader.obstruction_check == Reader::print_) {
+            auto obstruction_test = check_obstruction();
+            current_no_obstruction = obstruction_test.first;
+            current_complete_fibers = obstruction_test.second;
+        }
+    }
+
+    THREAD_STATIC Example example;
+    compact_example.expand(example);
+
+    // The nef checks only look at the blowups done in the graph.
+    G.connections = example.blowups;
+
+    if (example.type <= Example::QHD_single_j_) {
+        if (reader.nef_check == Reader::print_) {
+            auto nef_result = single_is_nef(example.self_int,example.discrepancies,example.n[0],
+                example.extra_n[0],example.extra_orig[0],example.extra_pos[0],example.extra_border[0]);
+            example.nef = nef_result.first;
+            example.nef_warning = nef_result.second;
+        }
+        if (reader.effective_check == Reader::print_) {
+            example.effective = single_is_effective(example.self_int,example.discrepancies,example.n[0]);
+        }
+    }
+    else {
+        THREAD_STATIC std::vector<int> location;
+        location.assign(example.self_int.size(),-1);
+        for (int curve : example.chain[0]) location[curve] = 0;
+        for (int curve : example.chain[1]) location[curve] = 1;
+        if (reader.nef_check == Reader::print_) {
+            auto nef_result = double_is_nef(example.self_int,example.discrepancies,location,example.n,
+                example.extra_n,example.extra_orig,example.extra_pos,example.extra_border);
+            example.nef = nef_result.first;
+            example.nef_warning = nef_result.second;
+        }
+        if (reader.effective_check == Reader::print_) {
+            example.effective = double_is_effective(example.self_int,example.discrepancies,location,example.n);
+        }
+    }
+
+    if (reader.obstruction_check == Reader::print_) {
+        example.no_obstruction = current_no_obstruction;
+        example.complete_fibers = current_complete_fibers;
+    }
+
+    compact_example.nef = example.nef;
+    compact_example.nef_warning = example.nef_warning;
+    compact_example.effective = example.effective;
+    compact_example.no_obstruction = example.no_obstruction;
+    compact_example.complete_fibers = example.complete_fibers;
 }
+#endif // DEFER_PRINT_CHECKS
 
 void Searcher::get_curves_from_mask(long long mask) {
     // If a try curve is not included in the graph and contracted, we can ignore this case as it's the same as if the curve was included to begin with.
@@ -422,11 +763,11 @@ void Searcher::get_curves_from_mask(long long mask) {
     temp_included_curves.clear();
 
     // These two lines might be extremely expensive. TODO: think an alternative.
-    temp_self_int = reader_copy.self_int;
-    temp_included_curves = original_adj_map;
+    temp_self_int = reader.self_int;
+    temp_included_curves = reader.adj_map;
 
-    for (int curve : reader_copy.ignored_curves[test_index]) {
-        if (contains(reader_copy.K.used_components,curve)) {
+    for (int curve : reader.ignored_curves[test_index]) {
+        if (contains(reader.K.used_components,curve)) {
             temp_ignored_exceptional.insert(curve);
         }
         else {
@@ -434,9 +775,9 @@ void Searcher::get_curves_from_mask(long long mask) {
         }
     }
 
-    for (int curve : reader_copy.try_curves[test_index]) {
+    for (int curve : reader.try_curves[test_index]) {
         if (!(mask & 1)) {
-            if (contains(reader_copy.K.used_components,curve)) {
+            if (contains(reader.K.used_components,curve)) {
                 temp_ignored_exceptional.insert(curve);
             }
             else {
@@ -449,12 +790,12 @@ void Searcher::get_curves_from_mask(long long mask) {
         mask >>= 1;
     }
 
-    for (auto& choose_set : reader_copy.choose_curves[test_index]) {
+    for (auto& choose_set : reader.choose_curves[test_index]) {
         long long choose_total = (1ll<<choose_set.size()) - 1ll;
         long long choose_mask = mask%choose_total;
         for (int curve : choose_set) {
             if (!(choose_mask & 1)) {
-                if (contains(reader_copy.K.used_components,curve)) {
+                if (contains(reader.K.used_components,curve)) {
                     temp_ignored_exceptional.insert(curve);
                 }
                 else {
@@ -473,11 +814,11 @@ bool Searcher::get_curves_from_mask_exact_curves(long long mask) {
     temp_included_curves.clear();
 
     // These two lines might be extremely expensive. TODO: think an alternative.
-    temp_self_int = reader_copy.self_int;
-    temp_included_curves = original_adj_map;
+    temp_self_int = reader.self_int;
+    temp_included_curves = reader.adj_map;
 
-    for (int curve : reader_copy.ignored_curves[test_index]) {
-        if (contains(reader_copy.K.used_components,curve)) {
+    for (int curve : reader.ignored_curves[test_index]) {
+        if (contains(reader.K.used_components,curve)) {
             temp_ignored_exceptional.insert(curve);
         }
         else {
@@ -487,19 +828,19 @@ bool Searcher::get_curves_from_mask_exact_curves(long long mask) {
 
     THREAD_STATIC std::vector<int> chosen_curves;
     chosen_curves.resize(0);
-    int to_choose_from = reader_copy.try_curves[test_index].size();
-    for (auto& choose_set : reader_copy.choose_curves[test_index]) {
+    int to_choose_from = reader.try_curves[test_index].size();
+    for (auto& choose_set : reader.choose_curves[test_index]) {
         to_choose_from += choose_set.size();
     }
 
-    int to_choose = reader_copy.curves_used_exactly - reader_copy.fixed_curves[test_index].size();
+    int to_choose = reader.curves_used_exactly - reader.fixed_curves[test_index].size();
     algs::ith_combination(to_choose_from, to_choose, mask, chosen_curves);
 
     int curve_index = 0;
     int choice_index = 0;
-    for (int curve : reader_copy.try_curves[test_index]) {
+    for (int curve : reader.try_curves[test_index]) {
         if (choice_index >= to_choose or chosen_curves[choice_index] != curve_index) {
-            if (contains(reader_copy.K.used_components,curve)) {
+            if (contains(reader.K.used_components,curve)) {
                 temp_ignored_exceptional.insert(curve);
             }
             else {
@@ -513,11 +854,11 @@ bool Searcher::get_curves_from_mask_exact_curves(long long mask) {
         curve_index++;
     }
 
-    for (auto& choose_set : reader_copy.choose_curves[test_index]) {
+    for (auto& choose_set : reader.choose_curves[test_index]) {
         int included = 0;
         for (int curve : choose_set) {
             if (choice_index >= to_choose or chosen_curves[choice_index] != curve_index) {
-                if (contains(reader_copy.K.used_components,curve)) {
+                if (contains(reader.K.used_components,curve)) {
                     temp_ignored_exceptional.insert(curve);
                 }
                 else {
@@ -542,7 +883,7 @@ std::pair<bool,int> Searcher::check_obstruction() {
     // The second condition is specially too strict if there are nested blowups, but this suffices for now.
 
     int complete_fibers = 0;
-    for (auto& f : reader_copy.fibers) {
+    for (auto& f : reader.fibers) {
         bool is_complete = true;
         for (int curve : f) {
             if (!contains(curve_dict,curve)) {
@@ -554,7 +895,7 @@ std::pair<bool,int> Searcher::check_obstruction() {
             ++complete_fibers;
         }
     }
-    for (int curve : reader_copy.sections) {
+    for (int curve : reader.sections) {
         if (contains(curve_dict,curve) and temp_self_int[curve] < -1) {
             return {false,complete_fibers};
         }
@@ -4,35 +4,31 @@
 #include"config.hpp"
 #include"Graph.hpp" // Graph, vector, pair, tuple, set, multiset
 #include"Reader.hpp" // Reader, Canonical_Divisor
+#include"Invariant_Table.hpp" // Invariant_Key, Invariant_Set
 #include<sstream> // stringstream
 #include<queue> // queue
 #include<unordered_set> // unordered_set
 #include<map> // map
+#include<memory> // unique_ptr
+#include<fstream> // ofstream, istream
+#include<chrono> // steady_clock
+#include<functional> // greater
 
-#ifdef NO_REPEATED_SEARCH
-#include"Algorithms.hpp" // Trie
-#endif
+#include"Algorithms.hpp" // Trie, put_varint
 
 #ifdef MULTITHREAD
 #include<atomic> // atomic
 #endif
 
-typedef std::tuple<int,long long, long long> single_invariant;
-typedef std::tuple<int,long long, long long, long long, long long> double_invariant;
-typedef std::tuple<int,long long, long long> P_extremal_invariant;
-typedef std::tuple<int,char,int,int,int> single_QHD_invariant;
-typedef std::tuple<int,char,int,int,int,long long, long long> double_QHD_invariant;
-
-struct ill_hash {
-    inline size_t operator()(const std::tuple<int, long long, long long>& v) const {
-        return std::get<1>(v)^(std::get<2>(v)<<6)^(std::get<0>(v)<<12);
-    }
-};
-struct illll_hash {
-    inline size_t operator()(const std::tuple<int, long long, long long, long long, long long>& v) const {
-        return std::get<1>(v)^(std::get<3>(v)<<6)^(std::get<2>(v)<<3)^(std::get<4>(v)<<9)^(std::get<0>(v)<<12);
-    }
-};
+#ifdef SEARCH_STATS
+#ifdef MULTITHREAD
+#include<mutex> // mutex, lock_guard
+#endif
+// Code that only exists to count and time the search.
+#define STATS(...) __VA_ARGS__
+#else
+#define STATS(...)
+#endif
 
 class Wahl;
 
@@ -98,6 +94,7 @@ struct alignas(64) Example {
     int extra_n[2];
     int extra_orig[2];
     int extra_pos[2];
+    int extra_border[2]; // The new end of the chain after the extra blowups. Only needed to redo the nef check.
     std::vector<int> chain[2]; // For forks, concatenate branches.
     std::vector<int> self_int;
     std::vector<int> chain_original; // For P-extremal resolution
@@ -114,9 +111,265 @@ struct alignas(64) Example {
     bool effective;
 };
 
+// Memory where the searchers store the examples they find. Memory is taken from big chunks that are never moved or freed
+// until the arena is destroyed, so the examples can keep pointers to it.
+class Example_Arena {
+public:
+    inline unsigned char* allocate(size_t size) {
+        if (size > CHUNK_SIZE) {
+            // Too big for a chunk, give it its own memory.
+            big.emplace_back(new unsigned char[size]);
+            return big.back().get();
+        }
+        if (chunks.empty() or chunk_used + size > CHUNK_SIZE) {
+            chunks.emplace_back(new unsigned char[CHUNK_SIZE]);
+            chunk_used = 0;
+        }
+        unsigned char* result = chunks.back().get() + chunk_used;
+        chunk_used += size;
+        return result;
+    }
+
+private:
+    static constexpr size_t CHUNK_SIZE = 1 << 20;
+    std::vector<std::unique_ptr<unsigned char[]>> chunks;
+    std::vector<std::unique_ptr<unsigned char[]>> big;
+    size_t chunk_used = 0;
+};
+
+/*
+    File of test numbers, as written with Export_Pretests and read with Pretest_Input.
+        char magic[8] = "WAHLPRE"
+        varint differences: each test minus the previous one (the first one minus 0), with algs::put_varint.
+    Tests are in increasing order. Each thread writes the tests it passes to its own file as they come,
+    and Writer::export_pretest_data merges them at the end.
+*/
+class Pretest_Stream {
+public:
+    static constexpr char magic[8] = "WAHLPRE";
+
+    // Returns false if the file can't be opened.
+    inline bool open(const std::string& name) {
+        filename = name;
+        last = 0;
+        count = 0;
+        f.open(filename, std::ios::binary);
+        if (f.fail()) return false;
+        f.write(magic, sizeof(magic));
+        return true;
+    }
+
+    inline void push(long long test) {
+        algs::put_varint(buffer, test - last);
+        last = test;
+        ++count;
+        if (buffer.size() >= BUFFER_SIZE) flush();
+    }
+
+    inline void close() {
+        flush();
+        f.close();
+    }
+
+    // Checks the magic of a file opened for reading.
+    static inline bool read_magic(std::istream& in) {
+        char read[sizeof(magic)];
+        in.read(read, sizeof(read));
+        return in.gcount() == sizeof(read) and std::equal(read, read + sizeof(read), magic);
+    }
+
+    // Reads the next test into test, which must hold the previous one (or 0). Returns false at the end of the file.
+    static inline bool read(std::istream& in, long long& test) {
+        unsigned long long x = 0;
+        int shift = 0;
+        for (int c = in.get(); c != EOF; c = in.get()) {
+            x |= (unsigned long long)(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                test += x;
+                return true;
+            }
+            shift += 7;
+        }
+        return false;
+    }
+
+    std::string filename;
+    long long count = 0;
+
+private:
+    inline void flush() {
+        f.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+        buffer.clear();
+    }
+
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+    std::ofstream f;
+    std::vector<unsigned char> buffer;
+    long long last = 0;
+};
+
+// A sub-test that passed the pretest, with the time it took to build its graph and search it. See Slowest_Tests.
+struct Slow_Test {
+    double seconds;
+    long long position; // As counted by SubTests.
+    long long test; // The sub-test itself, different from position with Pretest_Input.
+    int test_number; // Which of the Tests.
+    long long mask; // Of the try and choose curves in that test.
+    int graph_size;
+    long long separations;
+    long long candidates;
+
+    inline bool operator>(const Slow_Test& other) const {
+        return seconds > other.seconds;
+    }
+};
+
+// Keeps the slowest sub-tests, the fastest of them on top.
+using Slow_Test_Heap = std::priority_queue<Slow_Test, std::vector<Slow_Test>, std::greater<Slow_Test>>;
+
+// A sub-test of the sample searched with Estimate. Its examples are found afterwards by their position.
+struct Estimate_Sample {
+    long long position; // In the sample, as Example::test.
+    int test_index; // Which of the Tests, each is sampled on its own.
+    bool passed_pretest;
+    double seconds; // From loading the sub-test to the end of its search. Negative until then.
+};
+
+#ifdef SEARCH_STATS
+// Counters and timers of one searcher. Each searcher keeps its own and copies them to its wrapper from time to time,
+// so the status and the report at the end can read them.
+struct Search_Stats {
+    enum Stage {
+        stage_get_curves,
+        stage_contract_exceptional,
+        stage_pretest,
+        stage_build_graph,
+        stage_obstruction,
+        stage_search,
+        stages
+    };
+
+    enum Kind {
+        kind_single,
+        kind_double,
+        kind_p_extremal,
+        kind_QHD_single,
+        kind_QHD_double,
+        kinds
+    };
+
+    static constexpr const char* stage_names[stages] = {
+        "get_curves", "contract_exceptional", "pretest", "build_graph", "obstruction", "search"
+    };
+    static constexpr const char* kind_names[kinds] = {
+        "single", "double", "p_extremal", "QHD_single", "QHD_double"
+    };
+
+    static inline Kind kind_of(Example::Type type) {
+        if (type == Example::single_) return kind_single;
+        if (type <= Example::QHD_single_j_) return kind_QHD_single;
+        if (type == Example::double_) return kind_double;
+        if (type == Example::p_extremal_) return kind_p_extremal;
+        return kind_QHD_double;
+    }
+
+    long long tests = 0; // Tests loaded.
+    long long ignored_tests = 0; // Tests discarded while loading.
+    long long passed_pretests = 0;
+    long long obstructed = 0; // Tests skipped by the obstruction check.
+    long long separations = 0; // Candidates of the graph, see Graph::next_candidate.
+
+    // By kind of search.
+    long long explored[kinds] = {}; // Candidates explored, before looking for blowups.
+    long long reduced[kinds] = {}; // Candidates reduced to chains or forks that get their invariants computed.
+    long long hits[kinds] = {}; // Those with valid invariants.
+    long long repeated[kinds] = {}; // Hits discarded because the invariants were already found.
+    long long not_nef[kinds] = {};
+    long long not_effective[kinds] = {};
+    long long examples[kinds] = {};
+
+    long long nanoseconds[stages] = {};
+
+    // Starts timing from now.
+    inline void start() {
+        last = std::chrono::steady_clock::now();
+    }
+
+    // Adds the time since the last start or lap to the given stage.
+    inline void lap(Stage stage) {
+        auto now = std::chrono::steady_clock::now();
+        nanoseconds[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(now - last).count();
+        last = now;
+    }
+
+    inline void add(const Search_Stats& other) {
+        tests += other.tests;
+        ignored_tests += other.ignored_tests;
+        passed_pretests += other.passed_pretests;
+        obstructed += other.obstructed;
+        separations += other.separations;
+        for (int i = 0; i < kinds; ++i) {
+            explored[i] += other.explored[i];
+            reduced[i] += other.reduced[i];
+            hits[i] += other.hits[i];
+            repeated[i] += other.repeated[i];
+            not_nef[i] += other.not_nef[i];
+            not_effective[i] += other.not_effective[i];
+            examples[i] += other.examples[i];
+        }
+        for (int i = 0; i < stages; ++i) {
+            nanoseconds[i] += other.nanoseconds[i];
+        }
+    }
+
+    inline long long total_hits() const {
+        long long total = 0;
+        for (int i = 0; i < kinds; ++i) total += hits[i];
+        return total;
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+};
+#endif // SEARCH_STATS
+
+// The form in which the examples are stored until they are written.
+// Only the data used to remove repetitions, sort and write the summary is kept as fields, the rest of the example is
+// encoded with variable length integers in an Example_Arena, and expanded only when needed.
+struct Compact_Example {
+    Compact_Example() = default;
+    // Encodes the example in the arena.
+    Compact_Example(const Example& example, Example_Arena& arena);
+
+    // Restores the example, with all its fields.
+    void expand(Example& example) const;
+
+    long long test;
+    long long n[2];
+    long long a[2];
+    long long Delta;
+    long long Omega;
+    const unsigned char* data;
+    int export_id;
+    int K2;
+    int complete_fibers;
+    int p;
+    int q;
+    int r;
+    int worm_hole_id;
+    int length[2]; // Sizes of the chains.
+    Example::Type type;
+    bool worm_hole;
+    bool worm_hole_conjecture_counterexample;
+    bool no_obstruction;
+    bool nef;
+    bool nef_warning;
+    bool effective;
+};
+
 class alignas(64) Searcher {
 public:
-    Searcher() : test_index(0), test_start(0), current_test(-1){}
+    Searcher(const Reader& reader) : test_index(0), test_start(0), current_test(-1), separations(0), candidates(0), use_budget(false), suspended(false), clock_countdown(0), estimate_samples(nullptr), scores(nullptr), reader(reader), keep_first(reader.keep_first), count_distinct(false) {}
 
     std::stringstream* err;
 
@@ -144,29 +397,142 @@ public:
     #endif
 
     #ifdef EXPORT_PRETEST_DATA
-        std::queue<long long> *passed_pretest_list;
+        Pretest_Stream *passed_pretest_list;
+    #endif
+
+    #ifdef PRINT_PASSED_PRETESTS_END
+        // With Stop_After_Examples, the positions that passed the pretest are recorded here. nullptr otherwise.
+        std::vector<long long> *passed_pretest_positions;
+    #endif
+
+    #ifdef SEARCH_STATS
+        Search_Stats stats;
+        Search_Stats *wrapper_stats;
+        #ifdef MULTITHREAD
+            std::mutex *wrapper_stats_mutex;
+        #endif
+
+        // Copies stats to the wrapper.
+        inline void publish_stats() {
+            #ifdef MULTITHREAD
+            std::lock_guard<std::mutex> lock(*wrapper_stats_mutex);
+            #endif
+            *wrapper_stats = stats;
+        }
     #endif
 
     bool current_no_obstruction;
     int current_complete_fibers;
 
+    // Work done in the current sub-test. Separations are the candidates given by the graph, see Graph::next_candidate,
+    // and candidates are the chains and forks explored from them.
+    long long separations;
+    long long candidates;
+
+    Slow_Test_Heap *slowest_tests;
+
+    // When the search of the current sub-test began.
+    std::chrono::steady_clock::time_point test_begin;
+
+    // Whether any of the budgets is set, see Reader::budget_separations.
+    bool use_budget;
+    // Whether the current sub-test went over a budget. Then the search unwinds without looking at more candidates.
+    bool suspended;
+    // Calls to over_budget left until the clock is read again.
+    int clock_countdown;
+    // Sub-tests that went over a budget, to be searched again with Pretest_Input.
+    std::vector<long long> *suspended_tests;
+
+    // With Estimate, every sub-test searched is recorded here. nullptr otherwise.
+    std::vector<Estimate_Sample> *estimate_samples;
+    std::chrono::steady_clock::time_point sample_begin;
+
+    // Stores the time of the last sample, if it is not stored yet.
+    inline void finish_sample() {
+        if (estimate_samples == nullptr or estimate_samples->empty() or estimate_samples->back().seconds >= 0) return;
+        estimate_samples->back().seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - sample_begin).count();
+    }
+
+    // With Search_Order: Heuristic, the tests that pass the pretest are only scored in a first pass, and stored here as (score, test).
+    // nullptr otherwise.
+    std::vector<std::pair<long long,long long>> *scores;
+
+    // Score of the current sub-test from what is known after the pretest: the Wahl chains P, the K^2, the curves,
+    // the curves meeting three or more others, and the fibers included completely. Weighted by Order_Weights.
+    long long score(int P, int K, int curve_number) const;
+
+    // Checked for every separation and every candidate explored.
+    inline bool over_budget() {
+        if (!use_budget) return false;
+        if (suspended) return true;
+        if ((reader.budget_separations > 0 and separations > reader.budget_separations) or
+            (reader.budget_candidates > 0 and candidates > reader.budget_candidates)) {
+            suspended = true;
+        }
+        else if (reader.budget_seconds > 0 and --clock_countdown <= 0) {
+            clock_countdown = 256;
+            suspended = std::chrono::duration<double>(std::chrono::steady_clock::now() - test_begin).count() > reader.budget_seconds;
+        }
+        return suspended;
+    }
+
     // expected K^2
     int current_K2;
     std::pair<bool,int> check_obstruction();
 
+    // Whether a check must be done while searching. With DEFER_PRINT_CHECKS, checks that only print their result
+    // are done after merging the results of all threads, in deferred_checks.
+    inline bool check_now(Reader::Setting setting) const {
+#ifdef DEFER_PRINT_CHECKS
+        return setting == Reader::skip_;
+#else
+        return setting != Reader::no_;
+#endif
+    }
+
+#ifdef DEFER_PRINT_CHECKS
+    // Does the checks set to print over an example found in any searcher. Rebuilds the test of the example if it's not the current one.
+    void deferred_checks(Compact_Example& example);
+#endif
+
+#ifdef SHARE_FOUND_INVARIANTS
+    // With Keep_First global, whether some thread found an example with these invariants in a previous test.
+    // Such a candidate would be discarded when merging, so it can be skipped right away.
+    bool found_before(const Invariant_Key& key) const;
+
+    // Records that an example with these invariants was found in the current test.
+    void share_found(const Invariant_Key& key);
+#endif
+
     //////////////////////////////////////////////////////
     // Result data
 
-    std::queue<Example> *results;
-    std::unordered_set<single_invariant,ill_hash> single_found;
-    std::unordered_set<double_invariant,illll_hash> double_found;
-    std::unordered_set<P_extremal_invariant,ill_hash> P_extremal_found;
-    std::set<single_QHD_invariant> single_QHD_found;
-    std::set<double_QHD_invariant> double_QHD_found;
+    std::queue<Compact_Example> *results;
+    Example_Arena *arena;
+
+    // With Stop_After_Examples and Wahl::merge_at_end, examples are counted by their invariants as they are found, see Wahl::count_distinct.
+    bool count_distinct;
+    void count_result();
+
+    // Stores the example in results.
+    inline void push_result(const Example& example) {
+        STATS(stats.examples[Search_Stats::kind_of(example.type)]++;)
+        results->emplace(example,*arena);
+        if (count_distinct) count_result();
+    }
+
+    Invariant_Set single_found;
+    Invariant_Set double_found;
+    Invariant_Set P_extremal_found;
+    Invariant_Set single_QHD_found;
+    Invariant_Set double_QHD_found;
     Graph G;
 
-    // A local copy to not access shared memory. Is this useful? IDK.
-    Reader reader_copy;
+    // Shared by all the searchers, read only. Settings a searcher needs to change are copied below.
+    const Reader& reader;
+
+    // Keep_First of the reader, except with Wahl::merge_at_end, where the searcher keeps the first example of each sub-test.
+    Reader::Setting keep_first;
 
     // Takes an included curve and gives it an index in the local example
     std::map<int,int> curve_dict;
@@ -201,9 +567,15 @@ public:
     std::vector<long long> temp_try_included_exceptional;
     std::vector<long long> temp_marked_exceptional;
 
-    std::map<int,std::multiset<int>> original_adj_map;
+    // During contract_exceptional, equal to contraction_stamp for the curves in temp_ignored_exceptional.
+    std::vector<long long> temp_ignored_stamp;
+    long long contraction_stamp;
+
+    // Fills the temporary data with the curves of current_test. Returns true if we should ignore the test.
+    bool load_test();
 
-    void get_mask_and_real_test(long long& mask, long long& real_test);
+    // Builds G, curve_dict and curve_translate from the temporary data.
+    void build_graph();
 
     void get_curves_from_mask(long long mask);
 
@@ -341,16 +713,38 @@ public:
 // Is this useful? IDK.
 class alignas(64) Searcher_Wrapper {
 public:
-    std::queue<Example> results;
+    std::queue<Compact_Example> results;
+    Example_Arena arena;
+    Slow_Test_Heap slowest_tests;
+    std::vector<long long> suspended_tests;
+    std::vector<Estimate_Sample> estimate_samples;
+    // Whether search only scores the tests, see Searcher::scores.
+    bool scoring = false;
+    std::vector<std::pair<long long,long long>> scores;
     Wahl *parent;
     std::stringstream err;
 
     void search();
 
     #ifdef EXPORT_PRETEST_DATA
-        std::queue<long long> passed_pretest_list;
+        Pretest_Stream passed_pretest_list;
+        // Tells apart the pretest files of each thread.
+        int id = 0;
     #endif // EXPORT_PRETEST_DATA
 
+    #ifdef PRINT_PASSED_PRETESTS_END
+        // See Searcher::passed_pretest_positions. Only the ones in the positions kept by Wahl::collect_results are reported.
+        std::vector<long long> passed_pretest_positions;
+    #endif
+
+    #ifdef SEARCH_STATS
+        // Written by the searcher, see Searcher::publish_stats.
+        Search_Stats stats;
+        #ifdef MULTITHREAD
+            std::mutex stats_mutex;
+        #endif
+    #endif
+
     #ifdef MULTITHREAD
         std::atomic<long long> current_test;
         #if defined(PRINT_PASSED_PRETESTS_END) || defined(PRINT_STATUS_EXTRA)
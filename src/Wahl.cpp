@@ -1,12 +1,18 @@
 #include"Wahl.hpp" // string, to_string
-#include"Searcher.hpp" // Searcher_Wrapper, queue, priority_queue, single_invariant, double_invariant, p_extremal_invariant and their hashes
+#include"Searcher.hpp" // Searcher_Wrapper, queue, priority_queue, Invariant_Set
 #include"Algorithms.hpp"
 #include<fstream> // ifstream
-#include"Writer.hpp" // export_jsonl, less_by_n, less_by_length, stable_sort
+#include<algorithm> // stable_sort, merge, lower_bound
+#include<random> // mt19937_64
+#include<set> // set
+#include<memory> // unique_ptr
+#include<cctype> // isspace
+#include"Writer.hpp" // export_jsonl, Sort_Key, sort_key_by_n, sort_key_by_length
 
 #ifdef MULTITHREAD
 #include<chrono> // milliseconds
 #include<thread> // thread, sleep_for
+#include<mutex> // mutex, lock_guard
 #endif
 
 #ifdef CATCH_SIGINT
@@ -15,21 +21,40 @@ std::atomic<bool> sigint_catched;
 #endif // CATCH_SIGINT
 
 Wahl::Wahl(int argc, char** argv) {
+    if (std::string(argv[1]) == "--reexport") {
+        reexport(argc,argv);
+        return;
+    }
+    if (std::string(argv[1]) == "--batch") {
+        batch(argc,argv);
+        return;
+    }
+
+    if (!load(argv[1], argc > 2 and std::string(argv[2]) == "D")) return;
+    search();
+    Write();
+}
+
+Wahl::Wahl() {}
+
+Wahl::~Wahl() {}
+
+bool Wahl::load(const std::string& filename, bool debug) {
     std::ifstream f;
-    f.open(argv[1]);
+    f.open(filename);
     if (f.fail()) {
-        std::cout << "Error while opening file \"" << argv[1] << "\". (Does it exist?)." << std::endl;
-        return;
+        std::cout << "Error while opening file \"" << filename << "\". (Does it exist?)." << std::endl;
+        return false;
     }
     reader.parse(f);
     f.close();
 
     if (reader.parse_only) {
         Writer::export_jsonl(reader);
-        return;
+        return false;
     }
 
-    if (argc > 2 and std::string(argv[2]) == "D") {
+    if (debug) {
         reader.output_filename = "Debug";
         reader.summary_filename = "Debug";
     }
@@ -37,6 +62,25 @@ Wahl::Wahl(int argc, char** argv) {
     // debugx(reader.tests_no);
 
     total_tests = reader.get_test_numbers(number_tests);
+
+    // Only the tests in the list are searched, and SubTests counts positions in the list.
+    if (!reader.pretest_input_filename.empty()) {
+        std::ifstream pretests(reader.pretest_input_filename, std::ios::binary);
+        if (pretests.fail() or !Pretest_Stream::read_magic(pretests)) {
+            reader.error("Could not read pretest file \"" + reader.pretest_input_filename + "\".");
+        }
+        long long test = 0;
+        while (Pretest_Stream::read(pretests, test)) {
+            if (test >= total_tests) {
+                reader.error("Test " + std::to_string(test) + " of the pretest file is out of bounds. Was it exported with the same curves?");
+            }
+            pretest_input.push_back(test);
+        }
+        pretests.close();
+        use_test_list = true;
+        std::cout << "Read " << pretest_input.size() << " tests from \"" << reader.pretest_input_filename << "\"." << std::endl;
+        total_tests = pretest_input.size();
+    }
     init_tests();
     current_test = 0;
 
@@ -52,8 +96,29 @@ Wahl::Wahl(int argc, char** argv) {
     else {
         reader.subtest_start = 0;
     }
+    if (reader.estimate > 0) {
+        sample_tests();
+    }
     std::cout << "Total tests: " << total_tests << std::endl;
 
+    stop_at = LLONG_MAX;
+    found_examples = 0;
+    distinct_found.clear();
+    if (reader.heuristic_order and (reader.estimate > 0 or reader.export_pretests == Reader::only_)) {
+        std::cout << "Search_Order: Heuristic does nothing with Estimate or Export_Pretests: Only." << std::endl;
+        reader.heuristic_order = false;
+    }
+    merge_at_end = reader.keep_first == Reader::keep_global_ and (reader.heuristic_order or reader.stop_after_examples > 0);
+#ifdef MULTITHREAD
+    write_threads = reader.threads;
+#else
+    write_threads = 1;
+#endif
+    return true;
+}
+
+// Stops the searchers on Ctrl-C, so that the examples found so far are written.
+static void catch_sigint() {
     #ifdef CATCH_SIGINT
     sigint_catched = false;
     std::signal(SIGINT,
@@ -63,14 +128,33 @@ Wahl::Wahl(int argc, char** argv) {
         }
     );
     #endif // CATCH_SIGINT
+}
+
+void Wahl::prepare_search(int threads) {
+    if (reader.heuristic_order) {
+        order_tests();
+    }
+    search_begin = std::chrono::steady_clock::now();
+
+#if defined(MULTITHREAD) && defined(SHARE_FOUND_INVARIANTS)
+    if (reader.keep_first == Reader::keep_global_) {
+        shared_found.init(SHARED_FOUND_LOG_SIZE);
+    }
+#endif
+    searchers = std::vector<Searcher_Wrapper>(threads);
+    for (int i = 0; i < threads; ++i) {
+        searchers[i].parent = this;
+        searchers[i].id = i;
+    }
+}
+
+void Wahl::search() {
+    catch_sigint();
 
 #ifdef MULTITHREAD
     int threads = reader.threads;
+    prepare_search(threads);
     std::vector<std::thread> spawns;
-    std::vector<Searcher_Wrapper> searchers(threads);
-    for (Searcher_Wrapper& searcher : searchers) {
-        searcher.parent = this;
-    }
     spawns.reserve(threads);
     for (int i = 0; i < threads; ++i) {
         spawns.emplace_back(&Searcher_Wrapper::search,&searchers[i]);
@@ -81,7 +165,7 @@ Wahl::Wahl(int argc, char** argv) {
     std::cout.precision(1);
     std::cout << "\e[s";
     long long mintest = 0;
-    while (mintest < total_tests) {
+    while (mintest < end_test()) {
 
 #ifdef CATCH_SIGINT
         if (sigint_catched) {
@@ -89,7 +173,6 @@ Wahl::Wahl(int argc, char** argv) {
             for (int i = 0; i < threads; ++i) {
                 spawns[i].join();
             }
-            Write(searchers);
             return;
         }
 #endif // CATCH_SIGINT
@@ -103,6 +186,12 @@ Wahl::Wahl(int argc, char** argv) {
 #ifdef PRINT_STATUS_EXTRA
             std::cout << " PPT: " << searchers[i].passed_pretests << " Ex: " << searchers[i].total_examples;
 #endif //PRINT_STATUS_EXTRA
+#ifdef SEARCH_STATS
+            {
+                std::lock_guard<std::mutex> lock(searchers[i].stats_mutex);
+                std::cout << " Sep: " << searchers[i].stats.separations << " Hits: " << searchers[i].stats.total_hits();
+            }
+#endif //SEARCH_STATS
             std::cout << '\n';
         }
         std::cout << double(mintest)*100./double(total_tests) << "% " << mintest << "/" << total_tests;
@@ -117,6 +206,16 @@ Wahl::Wahl(int argc, char** argv) {
         }
         std::cout << " PPT: " << pretests << " Ex: " << examples;
 #endif //PRINT_STATUS_EXTRA
+#ifdef SEARCH_STATS
+        long long separations = 0;
+        long long hits = 0;
+        for (int i = 0; i < threads; ++i) {
+            std::lock_guard<std::mutex> lock(searchers[i].stats_mutex);
+            separations += searchers[i].stats.separations;
+            hits += searchers[i].stats.total_hits();
+        }
+        std::cout << " Sep: " << separations << " Hits: " << hits;
+#endif //SEARCH_STATS
 
         std::cout.flush();
         std::this_thread::sleep_for(std::chrono::milliseconds(STATUS_WAIT));
@@ -130,7 +229,7 @@ Wahl::Wahl(int argc, char** argv) {
     std::cout << std::fixed;
     std::cout.precision(1);
     long long mintest = 0;
-    while (mintest < total_tests) {
+    while (mintest < end_test()) {
 
 #ifdef CATCH_SIGINT
         if (sigint_catched) {
@@ -138,7 +237,6 @@ Wahl::Wahl(int argc, char** argv) {
             for (int i = 0; i < threads; ++i) {
                 spawns[i].join();
             }
-            Write(searchers);
             return;
         }
 #endif // CATCH_SIGINT
@@ -157,6 +255,16 @@ Wahl::Wahl(int argc, char** argv) {
         }
         std::cout << " PPT: " << pretests << " Ex: " << examples;
 #endif //PRINT_STATUS_EXTRA
+#ifdef SEARCH_STATS
+        long long separations = 0;
+        long long hits = 0;
+        for (int i = 0; i < threads; ++i) {
+            std::lock_guard<std::mutex> lock(searchers[i].stats_mutex);
+            separations += searchers[i].stats.separations;
+            hits += searchers[i].stats.total_hits();
+        }
+        std::cout << " Sep: " << separations << " Hits: " << hits;
+#endif //SEARCH_STATS
 
         std::cout.flush();
         std::this_thread::sleep_for(std::chrono::milliseconds(STATUS_WAIT));
@@ -179,6 +287,122 @@ Wahl::Wahl(int argc, char** argv) {
 #endif
 #endif // PRINT_STATUS
 
+#else // ndef MULTITHREAD
+    prepare_search(1);
+    Searcher_Wrapper& searcher = searchers[0];
+#ifdef PRINT_STATUS
+    std::cout << std::fixed;
+    std::cout.precision(1);
+    searcher.search();
+    std::cout << std::endl;
+#else // ndef PRINT_STATUS
+    searcher.search();
+#endif // PRINT_STATUS
+
+#endif // MULTITHREAD
+}
+
+void Wahl::batch(int argc, char** argv) {
+    // Arguments starting with '@' are manifests, with one test file per line. Empty lines and lines starting with '#' are skipped.
+    std::vector<std::string> filenames;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.empty() or arg[0] != '@') {
+            filenames.push_back(arg);
+            continue;
+        }
+        std::ifstream manifest(arg.substr(1));
+        if (manifest.fail()) {
+            std::cout << "Error while opening manifest \"" << arg.substr(1) << "\". (Does it exist?)." << std::endl;
+            return;
+        }
+        std::string line;
+        while (std::getline(manifest, line)) {
+            while (!line.empty() and std::isspace((unsigned char)line.back())) line.pop_back();
+            if (line.empty() or line[0] == '#') continue;
+            filenames.push_back(line);
+        }
+    }
+
+    // Every file is parsed before searching, so that an error in any of them stops the batch before it begins. Each one is loaded
+    // again when its search starts, so only the configurations being searched or written are kept in memory.
+#ifdef MULTITHREAD
+    int pool = 1;
+#endif
+    for (auto& filename : filenames) {
+        std::ifstream f(filename);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". (Does it exist?)." << std::endl;
+            return;
+        }
+        Reader check;
+        check.parse(f);
+#ifdef MULTITHREAD
+        pool = std::max(pool, check.threads);
+#endif
+    }
+    const int n = filenames.size();
+
+#ifndef MULTITHREAD
+    for (int i = 0; i < n; ++i) {
+        std::cout << " - Searching " << i + 1 << "/" << n << ": " << filenames[i] << std::endl;
+        Wahl configuration;
+        if (!configuration.load(filenames[i], false)) continue;
+        configuration.search();
+        configuration.Write();
+#ifdef CATCH_SIGINT
+        if (sigint_catched) break;
+#endif
+    }
+#else
+    /*
+    All the configurations share one pool with the largest Threads of the files. Each thread searches the positions of a configuration
+    until there are none left, and then goes on to the next one, so the tail of a search overlaps the start of the next. The first thread
+    to reach a configuration loads it, and the last one to leave it writes its results, with one thread, while the rest keep searching.
+    */
+    std::vector<std::unique_ptr<Wahl>> configurations(n);
+    std::vector<std::mutex> locks(n);
+    std::vector<char> started(n, false);
+    std::unique_ptr<std::atomic<int>[]> finished(new std::atomic<int>[n]);
+    for (int i = 0; i < n; ++i) finished[i] = 0;
+
+    catch_sigint();
+    auto worker = [&] (int t) {
+        for (int i = 0; i < n; ++i) {
+            Wahl* configuration = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(locks[i]);
+                // After Ctrl-C, the configurations already started are written, and the rest are skipped.
+                if (!started[i] and !sigint_catched) {
+                    started[i] = true;
+                    std::cout << " - Searching " << i + 1 << "/" << n << ": " << filenames[i] << std::endl;
+                    std::unique_ptr<Wahl> loaded(new Wahl());
+                    if (loaded->load(filenames[i], false)) {
+                        loaded->write_threads = 1;
+                        loaded->prepare_search(pool);
+                        configurations[i] = std::move(loaded);
+                    }
+                }
+                configuration = configurations[i].get();
+            }
+            if (configuration) configuration->searchers[t].search();
+            if (++finished[i] == pool and configuration) {
+                configuration->Write();
+                configurations[i].reset();
+            }
+        }
+    };
+    std::vector<std::thread> spawns;
+    for (int t = 0; t < pool; ++t) {
+        spawns.emplace_back(worker, t);
+    }
+    for (auto& spawn : spawns) {
+        spawn.join();
+    }
+#endif
+}
+
+void Wahl::Write() {
 #ifdef OVERFLOW_CHECK
 
     std::ofstream error_file(ERROR_FILE);
@@ -189,52 +413,319 @@ Wahl::Wahl(int argc, char** argv) {
 
 #endif // OVERFLOW_CHECK
 
+#ifdef MULTITHREAD
     Write(searchers);
+#else
+    Write(searchers[0]);
+#endif
+}
 
-#else // ndef MULTITHREAD
-    Searcher_Wrapper searcher;
-    searcher.parent = this;
+void Wahl::sample_tests() {
+    // Positions of the search before the first sub-test of the given test, as a Tests number counted from 0.
+    auto position_of = [this] (long long test) -> long long {
+        if (reader.pretest_input_filename.empty()) {
+            return std::max(0ll, std::min(total_tests, test - reader.subtest_start));
+        }
+        auto begin = pretest_input.begin() + reader.subtest_start;
+        return std::lower_bound(begin, begin + total_tests, test) - begin;
+    };
+
+    // Each of the Tests is a stratum, and gets a part of the sample proportional to its amount of sub-tests.
+    // The parts are rounded down, and the ones with the largest remainders get one more.
+    const long long sample_size = std::min(reader.estimate, total_tests);
+    std::vector<long long> first_position, sample_parts;
+    std::vector<std::pair<double,int>> remainders;
+    long long test = 0, assigned = 0;
+    estimate_population = total_tests;
+    estimate_strata.clear();
+    for (size_t i = 0; i < number_tests.size(); ++i) {
+        long long start = position_of(test);
+        test += number_tests[i];
+        long long size = position_of(test) - start;
+        double part = (double)sample_size*(double)size/(double)total_tests;
+        first_position.push_back(start);
+        estimate_strata.push_back(size);
+        sample_parts.push_back(std::min(size, (long long)part));
+        assigned += sample_parts.back();
+        remainders.emplace_back(part - (double)sample_parts.back(), i);
+    }
+    std::sort(remainders.begin(), remainders.end(), std::greater<std::pair<double,int>>());
+    for (auto& remainder : remainders) {
+        if (assigned >= sample_size) break;
+        int i = remainder.second;
+        if (sample_parts[i] < estimate_strata[i]) {
+            sample_parts[i]++;
+            assigned++;
+        }
+    }
+
+    // Floyd's algorithm in each stratum, with a fixed seed so that the sample can be searched again.
+    std::mt19937_64 rng(1);
+    std::vector<long long> sample;
+    for (size_t i = 0; i < number_tests.size(); ++i) {
+        std::set<long long> chosen;
+        const long long size = estimate_strata[i];
+        for (long long j = size - sample_parts[i]; j < size; ++j) {
+            long long t = std::uniform_int_distribution<long long>(0, j)(rng);
+            if (!chosen.insert(t).second) chosen.insert(j);
+        }
+        for (long long position : chosen) {
+            sample.push_back(real_test(first_position[i] + position));
+        }
+    }
+
+    pretest_input.swap(sample);
+    reader.subtest_start = 0;
+    total_tests = pretest_input.size();
+    use_test_list = true;
+    std::cout << "Estimate: sampled " << total_tests << " from " << estimate_population << " sub-tests." << std::endl;
+
+    // Examples are counted in each sub-test on its own.
+    if (reader.keep_first == Reader::keep_global_) {
+        reader.keep_first = Reader::keep_local_;
+    }
+}
+
+void Wahl::order_tests() {
+    std::cout << "Scoring the sub-tests that pass the pretest." << std::endl;
+#ifdef MULTITHREAD
+    std::vector<Searcher_Wrapper> scorers(reader.threads);
+    std::vector<std::thread> spawns;
+    for (auto& scorer : scorers) {
+        scorer.parent = this;
+        scorer.scoring = true;
+    }
+    for (auto& scorer : scorers) {
+        spawns.emplace_back(&Searcher_Wrapper::search,&scorer);
+    }
+    for (auto& spawn : spawns) {
+        spawn.join();
+    }
+#else
+    std::vector<Searcher_Wrapper> scorers(1);
+    scorers[0].parent = this;
+    scorers[0].scoring = true;
+    scorers[0].search();
 #ifdef PRINT_STATUS
-    std::cout << std::fixed;
-    std::cout.precision(1);
-    searcher.search();
     std::cout << std::endl;
-#else // ndef PRINT_STATUS
-    searcher.search();
-#endif // PRINT_STATUS
+#endif
+#endif
+    std::vector<std::pair<long long,long long>> scores;
+    for (auto& scorer : scorers) {
+        scores.insert(scores.end(), scorer.scores.begin(), scorer.scores.end());
+    }
 
-#ifdef OVERFLOW_CHECK
+    // Ties are kept in the order of the tests, so that the order doesn't depend on the threads.
+    std::sort(scores.begin(), scores.end(), [] (const std::pair<long long,long long>& a, const std::pair<long long,long long>& b) {
+        return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    pretest_input.clear();
+    for (auto& p : scores) {
+        pretest_input.push_back(p.second);
+    }
 
-    std::ofstream error_file(ERROR_FILE);
-    error_file << searcher.err.rdbuf();
-    error_file.close();
+#ifdef EXPORT_PRETEST_DATA
+    // The search is not in increasing order, so the pretests are exported now instead of while searching.
+    if (reader.export_pretests != Reader::no_) {
+        std::vector<long long> tests = pretest_input;
+        std::sort(tests.begin(), tests.end());
+        Pretest_Stream exported;
+        if (exported.open(reader.pretest_filename)) {
+            for (long long test : tests) {
+                exported.push(test);
+            }
+            exported.close();
+            std::cout << "Exported " << exported.count << " pretests to \"" << reader.pretest_filename << "\"." << std::endl;
+        }
+        else {
+            std::cout << "Error while opening file \"" << reader.pretest_filename << "\". Aborting pretest data export." << std::endl;
+        }
+        reader.export_pretests = Reader::no_;
+    }
+#endif
 
-#endif // OVERFLOW_CHECK
+    use_test_list = true;
+    reader.subtest_start = 0;
+    total_tests = pretest_input.size();
+    current_test = 0;
+    init_tests();
+    std::cout << total_tests << " sub-tests passed the pretest. Searching them by decreasing score." << std::endl;
+}
 
-    Write(searcher);
+void Wahl::count_distinct(const Compact_Example& example) {
+    const Invariant_Key key = invariant_key(example);
+#ifdef MULTITHREAD
+    std::lock_guard<std::mutex> lock(distinct_found_mutex);
+#endif
+    if (distinct_found.insert(key)) found_examples++;
+}
 
-#endif // MULTITHREAD
+long long Wahl::collect_results(std::vector<std::queue<Compact_Example>*>& queues) {
+    std::vector<Compact_Example> examples;
+    for (auto queue : queues) {
+        while (!queue->empty()) {
+            examples.push_back(std::move(queue->front()));
+            queue->pop();
+        }
+    }
 
+    // Every position before stop_at was searched. The examples found in each position don't depend on the threads, since
+    // searchers don't share what they found in this case (see merge_at_end), so neither does the first position with enough of them.
+    long long searched = end_test();
+    const long long wanted = reader.stop_after_examples;
+    if (stop_at != LLONG_MAX and wanted > 0 and merge_at_end) {
+        // Repeated invariants are dropped by merge_first_found, so only the first example with each of them counts, in the
+        // order of the search. The stop waits for that many distinct invariants, see count_distinct.
+        std::stable_sort(examples.begin(), examples.end(), [] (const Compact_Example& a, const Compact_Example& b) {
+            return a.test < b.test;
+        });
+        Invariant_Set found;
+        long long examples_kept = 0;
+        for (size_t i = 0; i < examples.size() and examples_kept < wanted; ++i) {
+            const Compact_Example& ex = examples[i];
+            const bool paired = ex.type == Example::p_extremal_ and ex.worm_hole and !ex.worm_hole_conjecture_counterexample;
+            if (found.insert(invariant_key(ex))) {
+                examples_kept += paired ? 2 : 1;
+                if (examples_kept >= wanted) searched = std::min(searched, ex.test + 1);
+            }
+            if (paired) ++i;
+        }
+    }
+    else if (stop_at != LLONG_MAX and wanted > 0 and (long long)examples.size() >= wanted) {
+        std::vector<long long> positions;
+        positions.reserve(examples.size());
+        for (auto& ex : examples) {
+            positions.push_back(ex.test);
+        }
+        std::nth_element(positions.begin(), positions.begin() + (wanted - 1), positions.end());
+        searched = std::min(searched, positions[wanted - 1] + 1);
+    }
+
+    // Examples of the same test keep their order, so that the pairs of a worm hole stay together.
+    std::stable_sort(examples.begin(), examples.end(), [this] (const Compact_Example& a, const Compact_Example& b) {
+        return real_test(a.test) < real_test(b.test);
+    });
+    for (auto& ex : examples) {
+        if (ex.test < searched) {
+            queues[0]->push(std::move(ex));
+        }
+    }
+    if (stop_at != LLONG_MAX) {
+        std::cout << "Stopped early. Kept the examples of the first " << searched << " of " << total_tests << " sub-tests in the order of the search." << std::endl;
+    }
+    return searched;
 }
 
+Invariant_Key Wahl::invariant_key(const Compact_Example& ex) {
+    if (ex.type == Example::single_) {
+        return Invariant_Key::single(ex.K2,ex.n[0],std::min(ex.a[0],ex.n[0]-ex.a[0]));
+    }
+    if (ex.type == Example::p_extremal_) {
+        auto Omega_unif = algs::gcd_invmod(ex.Delta,ex.Omega).second;
+        return Invariant_Key::p_extremal(ex.K2,ex.Delta,std::min(ex.Omega,Omega_unif));
+    }
+    if (ex.type == Example::double_) {
+        auto unif_inv = Writer::uniformize_double_by_n(ex.n,ex.a);
+        return Invariant_Key::double_chain(ex.K2,std::get<0>(unif_inv),std::get<1>(unif_inv),std::get<2>(unif_inv),std::get<3>(unif_inv));
+    }
+    if (ex.type >= Example::QHD_single_a_ and ex.type <= Example::QHD_single_j_) {
+        return Invariant_Key::single_QHD(ex.K2,(char)ex.type,ex.p,ex.q,ex.r);
+    }
+    return Invariant_Key::double_QHD(ex.K2,(char)ex.type,ex.p,ex.q,ex.r,ex.n[1],std::min(ex.a[1],ex.n[1] - ex.a[1]));
+}
+
+void Wahl::merge_first_found(std::vector<std::queue<Compact_Example>*>& queues, std::vector<Compact_Example>& example_vector) {
+    // Keep a priority_queue of pairs, the first item being the test number, the second being the id of the searcher.
+    // The top item in the queue will have the smallest test number, so it shall be processed, along with all examples of the same test number
+    // After processing all examples of the given test number, add to the queue the next test number of the same searcher.
+    std::priority_queue<std::pair<long long,int>, std::vector<std::pair<long long,int>>, std::greater<std::pair<long long,int>>> q;
+
+    // Only the first example of each type will be added.
+    // The kind of example is part of the key, so one set is enough.
+    Invariant_Set found;
+
+    for (int i = 0; i < queues.size(); ++i) {
+        if (!queues[i]->empty()) {
+            q.emplace(queues[i]->front().test,i);
+        }
+    }
+
+    while (!q.empty()) {
+        const auto p = q.top();
+        q.pop();
+        const long long& test = p.first;
+        auto& searcher_queue = *queues[p.second];
+        while (!searcher_queue.empty() and searcher_queue.front().test == test) {
+            auto& ex = searcher_queue.front();
+
+            // In case of seeing an extremal resolution, add the next example too.
+            const bool next_paired = ex.type == Example::p_extremal_ and ex.worm_hole and !ex.worm_hole_conjecture_counterexample;
+
+            if (!found.insert(invariant_key(ex))) {
+                searcher_queue.pop();
+                if (next_paired) {
+                    // Skip the next one too.
+                    searcher_queue.pop();
+                }
+                continue;
+            }
+            example_vector.push_back(std::move(ex));
+            searcher_queue.pop();
+            if (next_paired) {
+                // Add the next one too.
+                example_vector.push_back(std::move(searcher_queue.front()));
+                searcher_queue.pop();
+            }
+        }
+        if (!searcher_queue.empty()) {
+            q.emplace(searcher_queue.front().test,p.second);
+        }
+    }
+}
+
+#ifdef PRINT_PASSED_PRETESTS_END
+// Pretests passed by the searcher in the first kept positions of the search, see Wahl::collect_results.
+static long long kept_pretests(const Searcher_Wrapper& searcher, long long kept) {
+    const auto& positions = searcher.passed_pretest_positions;
+    return searcher.passed_pretests - std::count_if(positions.begin(), positions.end(), [kept] (long long position) {
+        return position >= kept;
+    });
+}
+#endif
+
 void Wahl::Write(std::vector<Searcher_Wrapper>& searchers) {
 
-    #ifdef EXPORT_PRETEST_DATA
-    std::vector<long long> pretests_to_export;
-    if (reader.export_pretests != Reader::no_) {
-        int total_pretests = 0;
+    #ifdef SEARCH_STATS
+    std::vector<const Search_Stats*> stats;
+    for (auto& s : searchers) {
+        stats.push_back(&s.stats);
+    }
+    Writer::export_stats(reader, stats);
+    #endif
+
+    if (reader.slowest_tests > 0) {
+        std::vector<Slow_Test_Heap*> heaps;
         for (auto& s : searchers) {
-            total_pretests += s.passed_pretest_list.size();
+            heaps.push_back(&s.slowest_tests);
         }
-        pretests_to_export.reserve(total_pretests);
+        Writer::export_slowest_tests(reader, heaps);
+    }
+
+    if (reader.budget_separations > 0 or reader.budget_candidates > 0 or reader.budget_seconds > 0) {
+        std::vector<std::vector<long long>*> suspended;
         for (auto& s : searchers) {
-            while (!s.passed_pretest_list.empty()) {
-                pretests_to_export.push_back(s.passed_pretest_list.front());
-                s.passed_pretest_list.pop();
-            }
+            suspended.push_back(&s.suspended_tests);
+        }
+        Writer::export_retry_tests(reader, suspended);
+    }
+
+    #ifdef EXPORT_PRETEST_DATA
+    std::vector<Pretest_Stream*> pretests_to_export;
+    if (reader.export_pretests != Reader::no_) {
+        for (auto& s : searchers) {
+            s.passed_pretest_list.close();
+            pretests_to_export.push_back(&s.passed_pretest_list);
         }
-        std::sort(pretests_to_export.begin(),pretests_to_export.end());
-        pretests_to_export.resize(std::min((int) pretests_to_export.size(),MAX_PRETEST_EXPORTED));
     }
     if (reader.export_pretests == Reader::only_) {
         // Only export graph data
@@ -253,137 +744,52 @@ void Wahl::Write(std::vector<Searcher_Wrapper>& searchers) {
     }
     #endif
 
+    std::vector<std::queue<Compact_Example>*> queues;
+    for (Searcher_Wrapper& searcher : searchers) {
+        queues.push_back(&searcher.results);
+    }
+    long long kept = LLONG_MAX;
+    if (reader.heuristic_order or reader.stop_after_examples > 0 or reader.stop_after_seconds > 0) {
+        kept = collect_results(queues);
+    }
+
     // If keep_first is not global, we can push all examples from all threads in any order, and after sorting the result is deterministic.
-    std::vector<Example> example_vector;
+    std::vector<Compact_Example> example_vector;
     size_t total_examples = 0;
-    for (Searcher_Wrapper& searcher : searchers) {
-        total_examples += searcher.results.size();
+    for (auto queue : queues) {
+        total_examples += queue->size();
     }
     example_vector.reserve(total_examples);
 
     if (reader.keep_first != Reader::keep_global_) {
-        for (Searcher_Wrapper& searcher : searchers) {
-            while(!searcher.results.empty()) {
-                example_vector.push_back(std::move(searcher.results.front()));
-                searcher.results.pop();
+        for (auto queue : queues) {
+            while(!queue->empty()) {
+                example_vector.push_back(std::move(queue->front()));
+                queue->pop();
             }
         }
     }
     else {
-        // Keep a priority_queue of pairs, the first item being the test number, the second being the id of the searcher.
-        // The top item in the queue will have the smallest test number, so it shall be processed, along with all examples of the same test number
-        // After processing all examples of the given test number, add to the queue the next test number of the same searcher.
-        std::priority_queue<std::pair<long long,int>, std::vector<std::pair<long long,int>>, std::greater<std::pair<long long,int>>> q;
-
-        // Only the first example of each type will be added.
-        std::unordered_set<single_invariant,ill_hash> single_found;
-        std::unordered_set<double_invariant,illll_hash> double_found;
-        std::unordered_set<P_extremal_invariant,ill_hash> p_extremal_found;
-        std::set<single_QHD_invariant> single_QHD_found;
-        std::set<double_QHD_invariant> double_QHD_found;
-
-        for (int i = 0; i < searchers.size(); ++i) {
-            if (!searchers[i].results.empty()) {
-                q.emplace(searchers[i].results.front().test,i);
-            }
-        }
-
-        while (!q.empty()) {
-            const auto p = q.top();
-            q.pop();
-            const long long& test = p.first;
-            auto& searcher_queue = searchers[p.second].results;
-            while (!searcher_queue.empty() and searcher_queue.front().test == test) {
-                auto& ex = searcher_queue.front();
-
-                // In case of seeing an extremal resolution, add the next example too.
-                bool next_paired = false;
-
-                if (ex.type == Example::single_) {
-                    auto key = std::make_tuple(ex.K2,ex.n[0],std::min(ex.a[0],ex.n[0]-ex.a[0]));
-                    if (contains(single_found,key)) {
-                        searcher_queue.pop();
-                        continue;
-                    }
-                    else {
-                        single_found.insert(key);
-                    }
-                }
-                else if (ex.type == Example::p_extremal_) {
-                    auto Delta = ex.Delta;
-                    auto Omega = ex.Omega;
-                    auto Omega_unif = algs::gcd_invmod(Delta,Omega).second;
-                    Omega = std::min(Omega,Omega_unif);
-                    auto key = std::make_tuple(ex.K2,Delta,Omega);
-
-                    next_paired = ex.worm_hole and !ex.worm_hole_conjecture_counterexample;
-
-                    if (contains(p_extremal_found,key)) {
-                        searcher_queue.pop();
-                        if (next_paired) {
-                            // Skip the next one too.
-                            searcher_queue.pop();
-                        }
-                        continue;
-                    }
-                    else {
-                        p_extremal_found.insert(key);
-                    }
-                }
-                else if (ex.type == Example::double_) {
-                    auto unif_inv = Writer::uniformize_double_by_n(ex.n,ex.a);
-                    auto key = std::make_tuple(ex.K2,std::get<0>(unif_inv),std::get<1>(unif_inv),std::get<2>(unif_inv),std::get<3>(unif_inv));
-                    if (contains(double_found,key)) {
-                        searcher_queue.pop();
-                        continue;
-                    }
-                    else {
-                        double_found.insert(key);
-                    }
-                }
-                else if (ex.type >= Example::QHD_single_a_ and ex.type <= Example::QHD_single_j_) {
-                    auto key = std::make_tuple(ex.K2,(char)ex.type,ex.p,ex.q,ex.r);
-                    if (contains(single_QHD_found,key)) {
-                        searcher_queue.pop();
-                        continue;
-                    }
-                    else {
-                        single_QHD_found.insert(key);
-                    }
-                }
-                else if (ex.type >= Example::QHD_double_a_ and ex.type <= Example::QHD_partial_j_) {
-                    auto key = std::make_tuple(ex.K2,(char)ex.type,ex.p,ex.q,ex.r,ex.n[1],std::min(ex.a[1],ex.n[1] - ex.a[1]));
-                    if (contains(double_QHD_found,key)) {
-                        searcher_queue.pop();
-                        continue;
-                    }
-                    else {
-                        double_QHD_found.insert(key);
-                    }
-                }
-                example_vector.push_back(std::move(ex));
-                searcher_queue.pop();
-                if (next_paired) {
-                    // Add the next one too.
-                    example_vector.push_back(std::move(searcher_queue.front()));
-                    searcher_queue.pop();
-                }
-            }
-            if (!searcher_queue.empty()) {
-                q.emplace(searcher_queue.front().test,p.second);
-            }
-        }
+        merge_first_found(queues, example_vector);
     }
     #ifdef PRINT_PASSED_PRETESTS_END
     long long passed_pretests = 0;
     for (auto& s : searchers) {
-        passed_pretests += s.passed_pretests;
+        passed_pretests += kept_pretests(s, kept);
     }
     std::cout << "Done! " << passed_pretests << " pretests passed and found " << example_vector.size() << " examples." << std::endl;
     #else
     std::cout << "Done! Found " << example_vector.size() << " examples." << std::endl;
     #endif
 
+    if (reader.estimate > 0) {
+        std::vector<std::vector<Estimate_Sample>*> samples;
+        for (auto& s : searchers) {
+            samples.push_back(&s.estimate_samples);
+        }
+        Writer::export_estimate(reader, estimate_population, estimate_strata, samples, example_vector);
+    }
+
     #ifdef EXPORT_PRETEST_DATA
     if (reader.export_pretests != Reader::no_) {
         Writer::export_pretest_data(reader,pretests_to_export);
@@ -396,14 +802,23 @@ void Wahl::Write(std::vector<Searcher_Wrapper>& searchers) {
 
 void Wahl::Write(Searcher_Wrapper& searcher) {
 
+    #ifdef SEARCH_STATS
+    Writer::export_stats(reader, {&searcher.stats});
+    #endif
+
+    if (reader.slowest_tests > 0) {
+        Writer::export_slowest_tests(reader, {&searcher.slowest_tests});
+    }
+
+    if (reader.budget_separations > 0 or reader.budget_candidates > 0 or reader.budget_seconds > 0) {
+        Writer::export_retry_tests(reader, {&searcher.suspended_tests});
+    }
+
     #ifdef EXPORT_PRETEST_DATA
-    std::vector<long long> pretests_to_export;
+    std::vector<Pretest_Stream*> pretests_to_export;
     if (reader.export_pretests != Reader::no_) {
-        pretests_to_export.reserve(searcher.passed_pretest_list.size());
-        while (!searcher.passed_pretest_list.empty()) {
-            pretests_to_export.push_back(searcher.passed_pretest_list.front());
-            searcher.passed_pretest_list.pop();
-        }
+        searcher.passed_pretest_list.close();
+        pretests_to_export.push_back(&searcher.passed_pretest_list);
     }
     if (reader.export_pretests == Reader::only_) {
         // Only export graph data
@@ -418,19 +833,34 @@ void Wahl::Write(Searcher_Wrapper& searcher) {
     }
     #endif
 
+    std::vector<std::queue<Compact_Example>*> queues = {&searcher.results};
+    long long kept = LLONG_MAX;
+    if (reader.heuristic_order or reader.stop_after_examples > 0 or reader.stop_after_seconds > 0) {
+        kept = collect_results(queues);
+    }
+
     // Move all the results into a vector and also create another vector of references to it. We will sort the second one to export to the jsonl and summary files. Also, use the un sorted vector to recover the pairs of examples given by worm holes.
-    std::vector<Example> example_vector;
+    std::vector<Compact_Example> example_vector;
     example_vector.reserve(searcher.results.size());
-    while (!searcher.results.empty()) {
-        example_vector.push_back(std::move(searcher.results.front()));
-        searcher.results.pop();
+    if (merge_at_end) {
+        merge_first_found(queues, example_vector);
+    }
+    else {
+        while (!searcher.results.empty()) {
+            example_vector.push_back(std::move(searcher.results.front()));
+            searcher.results.pop();
+        }
     }
     #ifdef PRINT_PASSED_PRETESTS_END
-    std::cout << "Done! " << searcher.passed_pretests << " pretests passed and found " << example_vector.size() << " examples." << std::endl;
+    std::cout << "Done! " << kept_pretests(searcher, kept) << " pretests passed and found " << example_vector.size() << " examples." << std::endl;
     #else
     std::cout << "Done! Found " << example_vector.size() << " examples." << std::endl;
     #endif
 
+    if (reader.estimate > 0) {
+        Writer::export_estimate(reader, estimate_population, estimate_strata, {&searcher.estimate_samples}, example_vector);
+    }
+
     #ifdef EXPORT_PRETEST_DATA
     if (reader.export_pretests != Reader::no_) {
         Writer::export_pretest_data(reader,pretests_to_export);
@@ -440,26 +870,111 @@ void Wahl::Write(Searcher_Wrapper& searcher) {
     Write(example_vector);
 }
 
-void Wahl::Write(std::vector<Example>& example_vector) {
+#ifdef DEFER_PRINT_CHECKS
+void Wahl::deferred_checks(std::vector<Compact_Example>& example_vector) {
+    if (reader.nef_check != Reader::print_ and reader.effective_check != Reader::print_ and reader.obstruction_check != Reader::print_) return;
+
+    // Examples of the same test are contiguous, so give each thread a contiguous range to rebuild each test once.
+    auto check_range = [this, &example_vector] (size_t start, size_t end) {
+        Searcher worker(reader);
+        worker.parent = this;
+        worker.init();
+        for (size_t i = start; i < end; ++i) {
+            worker.deferred_checks(example_vector[i]);
+        }
+    };
+
+#ifdef MULTITHREAD
+    const size_t size = example_vector.size();
+    const size_t range = (size + write_threads - 1)/write_threads;
+    std::vector<std::thread> spawns;
+    for (size_t start = 0; start < size; start += range) {
+        spawns.emplace_back(check_range, start, std::min(start + range, size));
+    }
+    for (auto& spawn : spawns) {
+        spawn.join();
+    }
+#else
+    check_range(0,example_vector.size());
+#endif
+}
+#endif // DEFER_PRINT_CHECKS
 
-    std::vector<Example*> ptr_example_vector;
-    ptr_example_vector.reserve(example_vector.size());
-    for (Example& ex : example_vector) ptr_example_vector.push_back(&ex);
+void Wahl::sort_examples(std::vector<Compact_Example>& example_vector, std::vector<Compact_Example*>& ptr_example_vector) {
+    const size_t size = example_vector.size();
+    ptr_example_vector.resize(size);
+    if (reader.summary_sort != Reader::sort_by_n_ and reader.summary_sort != Reader::sort_by_length_) {
+        for (size_t i = 0; i < size; ++i) ptr_example_vector[i] = &example_vector[i];
+        return;
+    }
 
-    if (reader.summary_sort == Reader::sort_by_n_) {
-        std::stable_sort(ptr_example_vector.begin(),ptr_example_vector.end(),
-            [] (const Example* a, const Example* b) -> bool {
-                return Writer::less_by_n(*a,*b);
-            }
-        );
+    // Build the keys once and sort them along with the examples. Keys are compared word by word, without touching the examples.
+    std::vector<std::pair<Writer::Sort_Key,Compact_Example*>> keys(size), merged;
+    auto less = [] (const std::pair<Writer::Sort_Key,Compact_Example*>& a, const std::pair<Writer::Sort_Key,Compact_Example*>& b) -> bool {
+        return a.first < b.first;
+    };
+
+    // Each range is keyed and sorted by itself. Ranges are in the order of example_vector, so merging them keeps the sort stable.
+    auto sort_range = [this, &example_vector, &keys, &less] (size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            if (reader.summary_sort == Reader::sort_by_n_) Writer::sort_key_by_n(example_vector[i], keys[i].first);
+            else Writer::sort_key_by_length(example_vector[i], keys[i].first);
+            keys[i].second = &example_vector[i];
+        }
+        std::stable_sort(keys.begin() + start, keys.begin() + end, less);
+    };
+
+#ifdef MULTITHREAD
+    const size_t range = std::max((size_t)1, (size + write_threads - 1)/write_threads);
+    std::vector<size_t> bounds;
+    std::vector<std::thread> spawns;
+    for (size_t start = 0; start < size; start += range) {
+        bounds.push_back(start);
+        spawns.emplace_back(sort_range, start, std::min(start + range, size));
+    }
+    bounds.push_back(size);
+    for (auto& spawn : spawns) {
+        spawn.join();
     }
-    else if (reader.summary_sort == Reader::sort_by_length_) {
-        std::stable_sort(ptr_example_vector.begin(),ptr_example_vector.end(),
-            [] (const Example* a, const Example* b) -> bool {
-                return Writer::less_by_length(*a,*b);
+
+    // Merge neighbouring ranges in parallel until one is left.
+    merged.resize(size);
+    while (bounds.size() > 2) {
+        std::vector<size_t> next_bounds;
+        spawns.clear();
+        for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+            next_bounds.push_back(bounds[i]);
+            if (i + 2 < bounds.size()) {
+                spawns.emplace_back([&keys, &merged, &less] (size_t start, size_t middle, size_t end) {
+                    std::merge(keys.begin() + start, keys.begin() + middle, keys.begin() + middle, keys.begin() + end, merged.begin() + start, less);
+                }, bounds[i], bounds[i+1], bounds[i+2]);
+            }
+            else {
+                std::copy(keys.begin() + bounds[i], keys.begin() + bounds[i+1], merged.begin() + bounds[i]);
             }
-        );
+        }
+        next_bounds.push_back(size);
+        for (auto& spawn : spawns) {
+            spawn.join();
+        }
+        keys.swap(merged);
+        bounds.swap(next_bounds);
     }
+#else
+    sort_range(0,size);
+#endif
+
+    for (size_t i = 0; i < size; ++i) ptr_example_vector[i] = keys[i].second;
+}
+
+void Wahl::Write(std::vector<Compact_Example>& example_vector) {
+
+#ifdef DEFER_PRINT_CHECKS
+    deferred_checks(example_vector);
+#endif
+
+    std::vector<Compact_Example*> ptr_example_vector;
+    sort_examples(example_vector, ptr_example_vector);
 
     for (int i = 0; i < ptr_example_vector.size(); ++i) {
         ptr_example_vector[i]->export_id = i;
@@ -476,7 +991,10 @@ void Wahl::Write(std::vector<Example>& example_vector) {
             i++;
         }
     }
-    Writer::export_jsonl(reader,ptr_example_vector);
+    Writer::export_jsonl(reader,ptr_example_vector,write_threads);
+    if (reader.binary_output) {
+        Writer::export_binary(reader,ptr_example_vector);
+    }
 
     if (reader.summary_style == Reader::plain_text_) {
         Writer::export_summary_text(reader,ptr_example_vector);
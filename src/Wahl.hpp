@@ -2,10 +2,18 @@
 #ifndef WAHL_HPP
 #define WAHL_HPP
 #include"Reader.hpp" // Reader, vector
+#include"Invariant_Table.hpp" // Shared_Invariant_Table
+#include<queue> // queue
+#include<chrono> // steady_clock
+#include<climits> // LLONG_MAX
+#include<algorithm> // min
 
 #if defined(MULTITHREAD) || defined(CATCH_SIGINT)
 #include<atomic> // atomic
 #endif
+#ifdef MULTITHREAD
+#include<mutex> // mutex
+#endif
 
 #ifdef CATCH_SIGINT
 extern std::atomic<bool> sigint_catched;
@@ -13,12 +21,27 @@ extern std::atomic<bool> sigint_catched;
 
 class Searcher;
 class Searcher_Wrapper;
-struct Example;
+struct Compact_Example;
 
 class Wahl
 {
 public:
     Wahl(int argc, char** argv);
+    Wahl();
+    ~Wahl();
+
+    // Reads the test file and prepares the tests to search. Returns false if there is nothing to search.
+    bool load(const std::string& filename, bool debug);
+
+    // Orders the tests if needed and makes the given amount of searchers, without starting them.
+    void prepare_search(int threads);
+
+    // Searches with the threads of the test file, keeping the searchers for Write.
+    void search();
+
+    // Searches every test file given after --batch, or listed in the manifests given as @manifest, in order. On multithread, all
+    // of them share one pool of threads, and each one is written by the last thread to finish it while the rest search the next.
+    void batch(int argc, char** argv);
 
     inline void init_tests() {
 #ifdef MULTITHREAD
@@ -58,6 +81,68 @@ public:
 #endif
     }
 
+    // Number of the test at the given position of the search. Positions start at subtest_start, and go through the Pretest_Input list
+    // or the sample of Estimate if there is one.
+    inline long long real_test(long long test) const {
+        test += reader.subtest_start;
+        return use_test_list ? pretest_input[test] : test;
+    }
+
+    // Replaces the tests to search with a random sample of Estimate sub-tests, taken from each of the Tests in proportion to its size.
+    void sample_tests();
+
+    // Scores the sub-tests that pass the pretest and replaces the tests to search with them, by decreasing score.
+    void order_tests();
+
+    // Positions of the search given to some searcher so far.
+    inline long long assigned_tests() const {
+#ifndef MULTITHREAD
+        return current_test;
+#else
+        long long assigned = current_test.load();
+        if (total_tests < (long long)(BULK_SIZE*MAX_THREADS) or assigned <= last_batch) return assigned;
+        return last_batch + (assigned - last_batch)/(long long)BULK_SIZE;
+#endif
+    }
+
+    // Called before taking each test. After Stop_After_Examples or Stop_After_Seconds, no more positions are searched,
+    // but the ones already given to a searcher are finished, so that the positions searched are the first stop_at.
+    inline void check_stop() {
+        if (stop_at != LLONG_MAX) return;
+        if ((reader.stop_after_examples > 0 and found_examples >= reader.stop_after_examples) or
+            (reader.stop_after_seconds > 0 and std::chrono::duration<double>(std::chrono::steady_clock::now() - search_begin).count() > reader.stop_after_seconds)) {
+#ifndef MULTITHREAD
+            stop_at = assigned_tests();
+#else
+            long long expected = LLONG_MAX;
+            stop_at.compare_exchange_strong(expected, assigned_tests());
+#endif
+        }
+    }
+
+    // Last position to search, plus one.
+    inline long long end_test() const {
+        return std::min(total_tests, (long long)stop_at);
+    }
+
+    // Counts an example found for Stop_After_Examples when merge_at_end is set. Only examples with new invariants count,
+    // since the rest are dropped by merge_first_found.
+    void count_distinct(const Compact_Example& example);
+
+    // Moves the examples of all the queues to the first one, in the order of the tests they were found in. If the search stopped
+    // after Stop_After_Examples, keeps only the first positions that have that many examples, which don't depend on the threads.
+    // Returns the amount of positions kept.
+    long long collect_results(std::vector<std::queue<Compact_Example>*>& queues);
+
+    // The key merge_first_found tells repeated examples apart with.
+    static Invariant_Key invariant_key(const Compact_Example& example);
+
+    // Keeps the first example with each invariants, as Keep_First global. Each queue must be in the order of the tests.
+    void merge_first_found(std::vector<std::queue<Compact_Example>*>& queues, std::vector<Compact_Example>& example_vector);
+
+    // Writes the results of the searchers of search(). Invalidates them.
+    void Write();
+
     // Invalidates searcher
     void Write(Searcher_Wrapper& searcher);
 
@@ -65,19 +150,64 @@ public:
     void Write(std::vector<Searcher_Wrapper>& searchers);
 
     // Receives a processed vector of examples from the queues.
-    void Write(std::vector<Example>& example_vector);
+    void Write(std::vector<Compact_Example>& example_vector);
+
+    // Rewrites the summary and the jsonl file from a jsonl file of a previous search, with the settings of the given config file if any.
+    void reexport(int argc, char** argv);
+
+    // Fills ptr_example_vector with the examples in the order given by summary_sort.
+    void sort_examples(std::vector<Compact_Example>& example_vector, std::vector<Compact_Example*>& ptr_example_vector);
+
+#ifdef DEFER_PRINT_CHECKS
+    // Does the checks set to print over the examples that will be written.
+    void deferred_checks(std::vector<Compact_Example>& example_vector);
+#endif
 
     Reader reader;
     std::vector<long long> number_tests;
+    // Tests read from the Pretest_Input file, or sampled with Estimate, in increasing order.
+    std::vector<long long> pretest_input;
+    bool use_test_list = false;
+
+    // With Estimate, the amount of sub-tests the sample was taken from, in total and in each of the Tests.
+    long long estimate_population;
+    std::vector<long long> estimate_strata;
+
+    // With Keep_First global, searchers keep the examples of each sub-test as Keep_First local, and the first found is kept
+    // when writing. Needed when the first found in a searcher depends on the order or the stop.
+    bool merge_at_end = false;
+
+    std::chrono::steady_clock::time_point search_begin;
+
+#ifdef MULTITHREAD
+    std::atomic<long long> stop_at;
+    std::atomic<long long> found_examples;
+#else
+    long long stop_at;
+    long long found_examples;
+#endif
+    // Invariants of the examples counted by count_distinct.
+    Invariant_Set distinct_found;
+#ifdef MULTITHREAD
+    std::mutex distinct_found_mutex;
+#endif
 
 #ifdef MULTITHREAD
     std::atomic<long long> current_test;
     long long last_batch;
+#ifdef SHARE_FOUND_INVARIANTS
+    Shared_Invariant_Table shared_found;
+#endif
 #else
     long long current_test;
 #endif
 
     long long total_tests;
+
+    std::vector<Searcher_Wrapper> searchers;
+
+    // Threads used to write the results. In a batch, one, since the rest of the pool is still searching.
+    int write_threads = 1;
 };
 
 #endif
@@ -3,16 +3,90 @@
 #define WRITER_HPP
 
 #include"config.hpp"
-#include"Searcher.hpp" // Example, std::tuple
+#include"Searcher.hpp" // Example, Compact_Example, Pretest_Stream, std::tuple, std::priority_queue
 #include"Reader.hpp" // Reader, std::string, std::vector, std::map
+#include"Algorithms.hpp" // algs::gcd
 #include<algorithm> // std::min, std::max
 #include<fstream> // ofstream
 #include<climits> // INT_MAX
+#include<cstdio> // remove
+#include<charconv> // to_chars
+#include<type_traits> // enable_if_t, is_integral
+
+#ifdef MULTITHREAD
+#include<thread> // thread
+#include<functional> // ref
+#endif
 
 using std::get;
 
 namespace Writer {
 
+    // Text built in memory to be written to a file in big blocks.
+    // Numbers are formatted with to_chars, which doesn't look at the locale.
+    class Output_Buffer {
+    public:
+        inline Output_Buffer& operator<<(char c) {
+            text.push_back(c);
+            return *this;
+        }
+        inline Output_Buffer& operator<<(const char* s) {
+            text.append(s);
+            return *this;
+        }
+        inline Output_Buffer& operator<<(const std::string& s) {
+            text.append(s);
+            return *this;
+        }
+        template<typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+        inline Output_Buffer& operator<<(T x) {
+            char digits[24];
+            text.append(digits, std::to_chars(digits, digits + sizeof(digits), x).ptr);
+            return *this;
+        }
+
+        inline size_t size() const {
+            return text.size();
+        }
+
+        // Writes the text to f and empties the buffer.
+        inline void write_to(std::ostream& f) {
+            f.write(text.data(),text.size());
+            text.clear();
+        }
+
+    private:
+        std::string text;
+    };
+
+    // Order of an example in the summary and jsonl files, packed so that comparing two examples is comparing words.
+    // Built once per example by sort_key_by_n or sort_key_by_length, instead of recomputing the invariants on every comparison.
+    struct Sort_Key {
+        unsigned long long word[8];
+
+        inline bool operator<(const Sort_Key& other) const {
+            for (int i = 0; i < 8; ++i) {
+                if (word[i] != other.word[i]) return word[i] < other.word[i];
+            }
+            return false;
+        }
+    };
+
+    // Maps signed numbers to unsigned ones preserving the order.
+    static unsigned long long sort_key_bias(long long x) {
+        return (unsigned long long) x ^ (1ULL << 63);
+    }
+    static unsigned long long sort_key_bias(int x) {
+        return (unsigned int) x ^ (1U << 31);
+    }
+
+    // Chain amount, then K^2, then non QHD < QHD, then the given type.
+    static unsigned long long sort_key_header(const Compact_Example& ex, int type) {
+        const bool qhd = ex.type != Example::single_ and ex.type != Example::double_ and ex.type != Example::p_extremal_;
+        const unsigned long long amount = ex.type <= Example::QHD_single_j_ ? 1 : 2;
+        return amount << 56 | sort_key_bias(ex.K2) << 24 | (unsigned long long) qhd << 16 | type;
+    }
+
     // Returns {n[0],n[1],a[0],a[1],len(chain[0]),len(chain[1])} after swapping so that (n[0],a[0]) >= (n[1],a[1])
     static std::tuple<long long, long long, long long, long long,int,int>
     uniformize_double_by_n(const long long n[2], const long long a[2], int length0 = 0, int length1 = 0) {
@@ -52,50 +126,35 @@ namespace Writer {
             5. Invariants of QHD
             6. (n[1],a[1])
             7. non p-extremal < p-extremal
-    Meant to be used with stable_sort and where the examples are already sorted by test
+    The last word of the key is the test number. Examples with equal keys must keep their order, so sort the keys with a stable sort.
 
     TODO: when p-extremal for QHD this will be inconsistent.
     */
-    static bool less_by_n(const Example& a, const Example& b) {
-        int amount_a = a.type <= Example::QHD_single_j_ ? 1 : 2;
-        int amount_b = b.type <= Example::QHD_single_j_ ? 1 : 2;
-        if (amount_a != amount_b) return amount_a < amount_b;
-        if (a.K2 != b.K2) return a.K2 < b.K2;
-        if (a.type == Example::single_) {
-            if (b.type != Example::single_) return true;
-            if (a.n[0] != b.n[0]) return a.n[0] < b.n[0];
-            long long min_a_a = std::min(a.a[0], a.n[0] - a.a[0]);
-            long long min_b_a = std::min(b.a[0], b.n[0] - b.a[0]);
-            if (min_a_a != min_b_a) return min_a_a < min_b_a;
-            return a.test < b.test;
-        }
-        else if (b.type == Example::single_) return false;
-        else if (a.type <= Example::QHD_single_j_) {
-            if (a.type != b.type) return a.type < b.type;
-            auto inv_a = std::make_tuple(a.p,a.q,a.r);
-            auto inv_b = std::make_tuple(b.p,b.q,b.r);
-            if (inv_a != inv_b) return inv_a < inv_b;
-            return a.test < b.test;
-        }
-        else if (a.type <= Example::p_extremal_) {
-            if (b.type > Example::p_extremal_) return true;
-            auto inv_a = uniformize_double_by_n(a.n,a.a);
-            auto inv_b = uniformize_double_by_n(b.n,b.a);
-            if (inv_a != inv_b) return inv_a < inv_b;
-            if (a.type != b.type) return a.type < b.type;
-            return a.test < b.test;
-        }
-        else if (b.type <= Example::p_extremal_) return false;
+    static void sort_key_by_n(const Compact_Example& ex, Sort_Key& key) {
+        const bool qhd = ex.type != Example::single_ and ex.type != Example::double_ and ex.type != Example::p_extremal_;
+        key = Sort_Key();
+        key.word[0] = sort_key_header(ex, qhd ? ex.type : 0);
+        if (ex.type == Example::single_) {
+            key.word[1] = sort_key_bias(ex.n[0]);
+            key.word[2] = sort_key_bias(std::min(ex.a[0], ex.n[0] - ex.a[0]));
+        }
+        else if (!qhd) {
+            auto inv = uniformize_double_by_n(ex.n,ex.a);
+            key.word[1] = sort_key_bias(get<0>(inv));
+            key.word[2] = sort_key_bias(get<1>(inv));
+            key.word[3] = sort_key_bias(get<2>(inv));
+            key.word[4] = sort_key_bias(get<3>(inv));
+            key.word[5] = ex.type;
+        }
         else {
-            if (a.type != b.type) return a.type < b.type;
-            auto inv_a = std::make_tuple(a.p,a.q,a.r);
-            auto inv_b = std::make_tuple(b.p,b.q,b.r);
-            if (inv_a != inv_b) return inv_a < inv_b;
-            auto inv_chain_a = std::make_tuple(a.n[1],std::min(a.a[1],a.n[1]-a.a[1]));
-            auto inv_chain_b = std::make_tuple(b.n[1],std::min(b.a[1],b.n[1]-b.a[1]));
-            if (inv_chain_a != inv_chain_b) return inv_chain_a < inv_chain_b;
-            return a.test < b.test;
+            key.word[1] = sort_key_bias(ex.p) << 32 | sort_key_bias(ex.q);
+            key.word[2] = sort_key_bias(ex.r) << 32;
+            if (ex.type > Example::QHD_single_j_) {
+                key.word[3] = sort_key_bias(ex.n[1]);
+                key.word[4] = sort_key_bias(std::min(ex.a[1], ex.n[1] - ex.a[1]));
+            }
         }
+        key.word[7] = sort_key_bias(ex.test);
     }
 
     // Returns {len(chain[0]),len(chain[1]),n[0],n[1],a[0],a[1]} after swapping so that (len(chain[0],n[0],a[0]) >= (len(chain[1],n[1],a[1])
@@ -148,72 +207,56 @@ namespace Writer {
             7. Invariants of QHD
             8. (n[1],a[1])
             9. non p-extremal < p-extremal
-    Meant to be used with stable_sort and where the examples are already sorted by test
+    The last word of the key is the test number. Examples with equal keys must keep their order, so sort the keys with a stable sort.
 
     TODO: when p-extremal for QHD this will be inconsistent.
     */
-    static bool less_by_length(const Example& a, const Example& b) {
-        int amount_a = a.type <= Example::QHD_single_j_ ? 1 : 2;
-        int amount_b = b.type <= Example::QHD_single_j_ ? 1 : 2;
-        if (amount_a != amount_b) return amount_a < amount_b;
-        if (a.K2 != b.K2) return a.K2 < b.K2;
-        if (a.type == Example::single_) {
-            if (b.type != Example::single_) return true;
-            if (a.chain[0].size() != b.chain[0].size()) return a.chain[0].size() < b.chain[0].size();
-            if (a.n[0] != b.n[0]) return a.n[0] < b.n[0];
-            long long min_a_a = std::min(a.a[0], a.n[0] - a.a[0]);
-            long long min_b_a = std::min(b.a[0], b.n[0] - b.a[0]);
-            if (min_a_a != min_b_a) return min_a_a < min_b_a;
-            return a.test < b.test;
-        }
-        else if (b.type == Example::single_) return false;
-        else if (a.type <= Example::QHD_single_j_) {
-            if (b.type > Example::QHD_single_j_) return true;
-            if (a.chain[0].size() != b.chain[0].size()) return a.chain[0].size() < b.chain[0].size();
-            if (a.type != b.type) return a.type < b.type;
-            auto inv_a = std::make_tuple(a.p,a.q,a.r);
-            auto inv_b = std::make_tuple(b.p,b.q,b.r);
-            if (inv_a != inv_b) return inv_a < inv_b;
-            return a.test < b.test;
-        }
-        else if (a.type <= Example::p_extremal_) {
-            if (b.type > Example::p_extremal_) return true;
-            auto inv_a = uniformize_double_by_length(a.n,a.a,a.chain[0].size(),a.chain[1].size());
-            auto inv_b = uniformize_double_by_length(b.n,b.a,b.chain[0].size(),b.chain[1].size());
-            if (inv_a != inv_b) return inv_a < inv_b;
-            if (a.type != b.type) return a.type < b.type;
-            return a.test < b.test;
-        }
-        else if (b.type <= Example::p_extremal_) return false;
+    static void sort_key_by_length(const Compact_Example& ex, Sort_Key& key) {
+        const bool qhd = ex.type != Example::single_ and ex.type != Example::double_ and ex.type != Example::p_extremal_;
+        const bool single = ex.type <= Example::QHD_single_j_;
+        key = Sort_Key();
+        key.word[0] = sort_key_header(ex, 0);
+        if (ex.type == Example::single_) {
+            key.word[1] = (unsigned long long) ex.length[0] << 32;
+            key.word[2] = sort_key_bias(ex.n[0]);
+            key.word[3] = sort_key_bias(std::min(ex.a[0], ex.n[0] - ex.a[0]));
+        }
+        else if (!qhd) {
+            auto inv = uniformize_double_by_length(ex.n,ex.a,ex.length[0],ex.length[1]);
+            key.word[1] = (unsigned long long) get<0>(inv) << 32 | get<1>(inv);
+            key.word[2] = sort_key_bias(get<2>(inv));
+            key.word[3] = sort_key_bias(get<3>(inv));
+            key.word[4] = sort_key_bias(get<4>(inv));
+            key.word[5] = sort_key_bias(get<5>(inv));
+            key.word[6] = ex.type;
+        }
         else {
-            if (a.chain[0].size() != b.chain[0].size()) return a.chain[0].size() < b.chain[0].size();
-            if (a.chain[1].size() != b.chain[1].size()) return a.chain[1].size() < b.chain[1].size();
-            if (a.type != b.type) return a.type < b.type;
-            auto inv_a = std::make_tuple(a.p,a.q,a.r);
-            auto inv_b = std::make_tuple(b.p,b.q,b.r);
-            if (inv_a != inv_b) return inv_a < inv_b;
-            auto inv_chain_a = std::make_tuple(a.n[1],std::min(a.a[1],a.n[1]-a.a[1]));
-            auto inv_chain_b = std::make_tuple(b.n[1],std::min(b.a[1],b.n[1]-b.a[1]));
-            if (inv_chain_a != inv_chain_b) return inv_chain_a < inv_chain_b;
-            return a.test < b.test;
+            key.word[1] = (unsigned long long) ex.length[0] << 32 | (single ? 0 : ex.length[1]);
+            key.word[2] = (unsigned long long) ex.type << 32 | sort_key_bias(ex.p);
+            key.word[3] = sort_key_bias(ex.q) << 32 | sort_key_bias(ex.r);
+            if (!single) {
+                key.word[4] = sort_key_bias(ex.n[1]);
+                key.word[5] = sort_key_bias(std::min(ex.a[1], ex.n[1] - ex.a[1]));
+            }
         }
+        key.word[7] = sort_key_bias(ex.test);
     }
 
 
-    static void json_export_bool(std::ostream& f, const char* name, bool value) {
+    static void json_export_bool(Output_Buffer& f, const char* name, bool value) {
         f << '\"' << name << "\":" << (value?"true":"false");
     }
 
     template<class T>
-    static void json_export_number(std::ostream& f, const char* name, T value) {
+    static void json_export_number(Output_Buffer& f, const char* name, T value) {
         f << '\"' << name << "\":" << value;
     }
 
-    static void json_export_char(std::ostream& f, const char* name, char value) {
+    static void json_export_char(Output_Buffer& f, const char* name, char value) {
         f << '\"' << name << "\":\"" << value << '\"';
     }
 
-    static void json_export_map(std::ostream& f, const char* name, const std::map<std::string,int>& var) {
+    static void json_export_map(Output_Buffer& f, const char* name, const std::map<std::string,int>& var) {
         f << '\"' << name << "\":{";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << '\"' << iter->first << "\":" << iter->second;
@@ -223,7 +266,7 @@ namespace Writer {
     }
 
     template<size_t n>
-    static void json_export_array(std::ostream& f, const char* name, const int var[n]) {
+    static void json_export_array(Output_Buffer& f, const char* name, const int var[n]) {
         f << '\"' << name << "\":[";
         for (int i = 0; i < n; ++i) {
             f << var[i];
@@ -232,7 +275,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream& f, const char* name, const std::vector<int>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<int>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << *iter;
@@ -241,7 +284,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream& f, const char* name, const std::vector<long long>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<long long>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << *iter;
@@ -250,7 +293,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream& f, const char* name, const std::vector<std::pair<int,int>>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<std::pair<int,int>>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << '[' << iter->first << ',' << iter->second << ']';
@@ -259,7 +302,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_set(std::ostream& f, const char* name, const std::set<int>& var) {
+    static void json_export_set(Output_Buffer& f, const char* name, const std::set<int>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << *iter;
@@ -268,7 +311,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream& f, const char* name, const std::vector<std::string>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<std::string>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << '\"' << *iter << '\"';
@@ -277,7 +320,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream&f, const char* name, const std::vector<std::vector<int>>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<std::vector<int>>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << '[';
@@ -291,7 +334,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void json_export_vector(std::ostream&f, const char* name, const std::vector<std::multiset<int>>& var) {
+    static void json_export_vector(Output_Buffer& f, const char* name, const std::vector<std::multiset<int>>& var) {
         f << '\"' << name << "\":[";
         for (auto iter = var.begin(); iter != var.end(); ++iter) {
             f << '[';
@@ -305,7 +348,7 @@ namespace Writer {
         f << ']';
     }
 
-    static void export_graph_data(std::ofstream& f, Reader& reader) {
+    static void export_graph_data(Output_Buffer& f, const Reader& reader) {
         f << '{';
 
         json_export_map(f,"id",reader.curve_id);
@@ -339,7 +382,7 @@ namespace Writer {
         f << "}\n";
     }
 
-    static void export_example_data(std::ofstream& f, Reader& reader, Example& example) {
+    static void export_example_data(Output_Buffer& f, const Reader& reader, const Example& example) {
         if (example.type == Example::single_) {
             f << '{';
             json_export_number(f,"#",1);
@@ -638,34 +681,394 @@ namespace Writer {
                 return;
             }
         }
-        export_graph_data(f,reader);
+        Output_Buffer buffer;
+        export_graph_data(buffer,reader);
+        buffer.write_to(f);
         f.close();
     }
 
-    static void export_jsonl(Reader& reader, std::vector<Example*>& ptr_examples) {
+#ifdef EXPORT_JSONL_INDEX
+    /*
+    Index of a jsonl file, written next to it with extension .jsonl.idx. All numbers are little endian.
+        char magic[8] = "WAHLIDX"
+        uint64 examples
+        uint64 buckets
+        uint64 offsets[examples + 2]: byte offset of each line, line 0 being the graph data and line i the example with index i. The last one is the size of the file.
+        Index_Bucket buckets[buckets]: sorted by (K2, type, n).
+        uint64 ids[examples]: indexes of the examples grouped by bucket. Bucket b has ids[start, start + count), in increasing order.
+    The type is the value of Example::Type and n is n[0], except for double and P-extremal examples where it is max(n[0],n[1]).
+    */
+    static constexpr char index_magic[8] = "WAHLIDX";
+
+    struct Index_Bucket {
+        int K2;
+        int type;
+        long long n;
+        unsigned long long start;
+        unsigned long long count;
+    };
+
+    static void export_jsonl_index(const std::string& filename, const std::vector<Compact_Example*>& ptr_examples, const std::vector<unsigned long long>& offsets) {
+        std::ofstream f(filename, std::ios::binary);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting jsonl index export." << std::endl;
+            return;
+        }
+
+        auto bucket_of = [&ptr_examples] (unsigned long long id) {
+            const Compact_Example& ex = *ptr_examples[id];
+            long long n = ex.n[0];
+            if (ex.type == Example::double_ or ex.type == Example::p_extremal_) n = std::max(ex.n[0],ex.n[1]);
+            return std::make_tuple(ex.K2, (int)ex.type, n);
+        };
+        std::vector<unsigned long long> ids(ptr_examples.size());
+        for (size_t i = 0; i < ids.size(); ++i) ids[i] = i;
+        std::stable_sort(ids.begin(), ids.end(), [&bucket_of] (unsigned long long a, unsigned long long b) {
+            return bucket_of(a) < bucket_of(b);
+        });
+
+        std::vector<Index_Bucket> buckets;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            auto bucket = bucket_of(ids[i]);
+            if (i == 0 or bucket != bucket_of(ids[i-1])) {
+                buckets.push_back({std::get<0>(bucket), std::get<1>(bucket), std::get<2>(bucket), i, 0});
+            }
+            buckets.back().count++;
+        }
+
+        const unsigned long long sizes[2] = {ptr_examples.size(), buckets.size()};
+        f.write(index_magic, sizeof(index_magic));
+        f.write(reinterpret_cast<const char*>(sizes), sizeof(sizes));
+        f.write(reinterpret_cast<const char*>(offsets.data()), offsets.size()*sizeof(unsigned long long));
+        f.write(reinterpret_cast<const char*>(buckets.data()), buckets.size()*sizeof(Index_Bucket));
+        f.write(reinterpret_cast<const char*>(ids.data()), ids.size()*sizeof(unsigned long long));
+        f.close();
+    }
+#endif
+
+    // Examples are expanded and formatted with the given amount of threads on multithread.
+    static void export_jsonl(Reader& reader, std::vector<Compact_Example*>& ptr_examples, int threads) {
         std::string filename = reader.output_filename + ".jsonl";
-        std::ofstream f(filename);
+        // Binary, so that the offsets in the index are the same as in the file.
+        std::ofstream f(filename, std::ios::binary);
         if (f.fail()) {
             std::cout << "Error while opening file \"" << filename << "\"." << std::endl;
             filename = DEFAULT_OUTPUT_NAME ".jsonl";
             std::cout << "Attempting to open default file \"" << filename << "\"." << std::endl;
             f.clear();
-            f.open(filename);
+            f.open(filename, std::ios::binary);
             if (f.fail()) {
                 std::cout << "Also failed. Aborting jsonl export." << std::endl;
                 return;
             }
         }
 
-        export_graph_data(f,reader);
-        for (Example* example : ptr_examples) {
-            export_example_data(f,reader,*example);
+        // Offset of each line of the file.
+        std::vector<unsigned long long> offsets;
+        offsets.reserve(ptr_examples.size() + 2);
+        offsets.push_back(0);
+
+        Output_Buffer buffer;
+        export_graph_data(buffer,reader);
+        unsigned long long position = buffer.size();
+        buffer.write_to(f);
+
+        // Each thread writes a block of consecutive examples into its own buffer, and the buffers are written in order.
+        // starts has the offset of each example within the buffer.
+        auto export_block = [&reader, &ptr_examples] (Output_Buffer& block_buffer, std::vector<size_t>& starts, size_t start, size_t end) {
+            Example example;
+            starts.clear();
+            for (size_t i = start; i < end; ++i) {
+                ptr_examples[i]->expand(example);
+                starts.push_back(block_buffer.size());
+                export_example_data(block_buffer,reader,example);
+            }
+        };
+        auto write_block = [&f, &offsets, &position] (Output_Buffer& block_buffer, const std::vector<size_t>& starts) {
+            for (size_t start : starts) offsets.push_back(position + start);
+            position += block_buffer.size();
+            block_buffer.write_to(f);
+        };
+
+        const size_t size = ptr_examples.size();
+#ifdef MULTITHREAD
+        threads = std::max(threads,1);
+        std::vector<Output_Buffer> buffers(threads);
+        std::vector<std::vector<size_t>> starts(threads);
+        std::vector<std::thread> spawns;
+        for (size_t start = 0; start < size; start += (size_t)threads*EXPORT_BLOCK_SIZE) {
+            spawns.clear();
+            for (int i = 0; i < threads and start + (size_t)i*EXPORT_BLOCK_SIZE < size; ++i) {
+                size_t block_start = start + (size_t)i*EXPORT_BLOCK_SIZE;
+                spawns.emplace_back(export_block, std::ref(buffers[i]), std::ref(starts[i]), block_start, std::min(block_start + EXPORT_BLOCK_SIZE, size));
+            }
+            for (int i = 0; i < spawns.size(); ++i) {
+                spawns[i].join();
+                write_block(buffers[i],starts[i]);
+            }
         }
+#else
+        std::vector<size_t> starts;
+        for (size_t start = 0; start < size; start += EXPORT_BLOCK_SIZE) {
+            export_block(buffer, starts, start, std::min(start + EXPORT_BLOCK_SIZE, size));
+            write_block(buffer, starts);
+        }
+#endif
+        offsets.push_back(position);
+        f.close();
+
+#ifdef EXPORT_JSONL_INDEX
+        export_jsonl_index(filename + ".idx", ptr_examples, offsets);
+#endif
+    }
+
+    /*
+    Binary database of examples, written with Binary_Output: Y. All numbers are little endian.
+    The file starts with a Binary_Header, followed by the first line of the jsonl file (the graph data),
+    the variable length data of the examples and the columns. Every section starts at a multiple of 8.
+    Column i has one entry per example, in the same order as the jsonl file, with the width given in binary_column_width[i].
+    The flags column has the bits given by Binary_Flag. The data_start column has one more entry than examples,
+    example i has its data in [data_offset + data_start[i], data_offset + data_start[i+1]), laid out as:
+        int32 sizes[binary_sizes]: used curves, blown down exceptionals, blowups (pairs), chain[0], chain[1], self_int,
+                                   discrepancies, chain_original, self_int_original.
+        int32 extra[8]: extra_n[0], extra_orig[0], extra_pos[0], extra_n[1], extra_orig[1], extra_pos[1], extra_border[0], extra_border[1].
+        int32 branch_permutation[3].
+        int64 discrepancies.
+        int32 used curves, blown down exceptionals, blowups, chain[0], chain[1], self_int, chain_original, self_int_original.
+        padding up to a multiple of 8.
+    */
+    enum Binary_Column {
+        column_test,
+        column_n0,
+        column_n1,
+        column_a0,
+        column_a1,
+        column_Delta,
+        column_Omega,
+        column_data_start,
+        column_K2,
+        column_p,
+        column_q,
+        column_r,
+        column_worm_hole_id,
+        column_complete_fibers,
+        column_type,
+        column_flags,
+        binary_columns
+    };
+    static constexpr int binary_column_width[binary_columns] = {8,8,8,8,8,8,8,8,4,4,4,4,4,4,1,1};
+
+    enum Binary_Flag {
+        flag_nef = 1,
+        flag_nef_warning = 2,
+        flag_effective = 4,
+        flag_no_obstruction = 8,
+        flag_worm_hole = 16,
+        flag_worm_hole_conjecture_counterexample = 32,
+        // In the header, which checks were done.
+        flag_nef_check = 1,
+        flag_effective_check = 2,
+        flag_obstruction_check = 4
+    };
+
+    static constexpr int binary_sizes = 9;
+    static constexpr char binary_magic[8] = "WAHLDB1";
+
+    struct Binary_Header {
+        char magic[8];
+        unsigned long long examples;
+        unsigned long long checks;
+        unsigned long long graph_offset;
+        unsigned long long graph_size;
+        unsigned long long data_offset;
+        unsigned long long data_size;
+        unsigned long long column_offset[binary_columns];
+    };
+
+    template<typename T>
+    static void binary_append(std::string& bytes, const T* values, size_t size) {
+        bytes.append(reinterpret_cast<const char*>(values), size*sizeof(T));
+    }
+
+    static void binary_pad(std::string& bytes) {
+        bytes.append((8 - bytes.size()%8)%8, '\0');
+    }
+
+    // Appends the variable length data of the example.
+    static void binary_example_data(std::string& bytes, const Example& example) {
+        const int fixed[binary_sizes + 11] = {
+            (int)example.used_curves.size(), (int)example.blown_down_exceptionals.size(), (int)example.blowups.size(),
+            (int)example.chain[0].size(), (int)example.chain[1].size(), (int)example.self_int.size(),
+            (int)example.discrepancies.size(), (int)example.chain_original.size(), (int)example.self_int_original.size(),
+            example.extra_n[0], example.extra_orig[0], example.extra_pos[0],
+            example.extra_n[1], example.extra_orig[1], example.extra_pos[1],
+            example.extra_border[0], example.extra_border[1],
+            example.branch_permutation[0], example.branch_permutation[1], example.branch_permutation[2]
+        };
+        binary_append(bytes, fixed, binary_sizes + 11);
+        binary_append(bytes, example.discrepancies.data(), example.discrepancies.size());
+        THREAD_STATIC std::vector<int> values;
+        values.assign(example.used_curves.begin(), example.used_curves.end());
+        values.insert(values.end(), example.blown_down_exceptionals.begin(), example.blown_down_exceptionals.end());
+        for (auto& blowup : example.blowups) {
+            values.push_back(blowup.first);
+            values.push_back(blowup.second);
+        }
+        values.insert(values.end(), example.chain[0].begin(), example.chain[0].end());
+        values.insert(values.end(), example.chain[1].begin(), example.chain[1].end());
+        values.insert(values.end(), example.self_int.begin(), example.self_int.end());
+        values.insert(values.end(), example.chain_original.begin(), example.chain_original.end());
+        values.insert(values.end(), example.self_int_original.begin(), example.self_int_original.end());
+        binary_append(bytes, values.data(), values.size());
+        binary_pad(bytes);
+    }
+
+    // Restores an example from its data in the binary database. The fixed fields are read from the columns.
+    static void binary_read_example_data(const char* data, Example& example) {
+        int sizes[binary_sizes];
+        int extra[8 + 3];
+        std::copy(data, data + sizeof(sizes), reinterpret_cast<char*>(sizes));
+        data += sizeof(sizes);
+        std::copy(data, data + sizeof(extra), reinterpret_cast<char*>(extra));
+        data += sizeof(extra);
+        example.extra_n[0] = extra[0];
+        example.extra_orig[0] = extra[1];
+        example.extra_pos[0] = extra[2];
+        example.extra_n[1] = extra[3];
+        example.extra_orig[1] = extra[4];
+        example.extra_pos[1] = extra[5];
+        example.extra_border[0] = extra[6];
+        example.extra_border[1] = extra[7];
+        for (int i = 0; i < 3; ++i) example.branch_permutation[i] = extra[8 + i];
+
+        example.discrepancies.resize(sizes[6]);
+        std::copy(data, data + sizes[6]*sizeof(long long), reinterpret_cast<char*>(example.discrepancies.data()));
+        data += sizes[6]*sizeof(long long);
+
+        auto next = [&data] () -> int {
+            int x;
+            std::copy(data, data + sizeof(int), reinterpret_cast<char*>(&x));
+            data += sizeof(int);
+            return x;
+        };
+        example.used_curves.clear();
+        for (int i = 0; i < sizes[0]; ++i) example.used_curves.insert(example.used_curves.end(), next());
+        example.blown_down_exceptionals.clear();
+        for (int i = 0; i < sizes[1]; ++i) example.blown_down_exceptionals.insert(example.blown_down_exceptionals.end(), next());
+        example.blowups.resize(sizes[2]);
+        for (auto& blowup : example.blowups) {
+            blowup.first = next();
+            blowup.second = next();
+        }
+        std::vector<int>* vectors[5] = {&example.chain[0], &example.chain[1], &example.self_int, &example.chain_original, &example.self_int_original};
+        const int vector_sizes[5] = {sizes[3], sizes[4], sizes[5], sizes[7], sizes[8]};
+        for (int j = 0; j < 5; ++j) {
+            vectors[j]->resize(vector_sizes[j]);
+            for (int& x : *vectors[j]) x = next();
+        }
+    }
+
+    static void export_binary(const Reader& reader, const std::vector<Compact_Example*>& ptr_examples) {
+        std::string filename = reader.output_filename + ".wdb";
+        std::ofstream f(filename, std::ios::binary);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting binary export." << std::endl;
+            return;
+        }
+
+        const size_t size = ptr_examples.size();
+        Binary_Header header = {};
+        std::copy(binary_magic, binary_magic + 8, header.magic);
+        header.examples = size;
+        header.checks =
+            (reader.nef_check != Reader::no_ ? flag_nef_check : 0) |
+            (reader.effective_check != Reader::no_ ? flag_effective_check : 0) |
+            (reader.obstruction_check != Reader::no_ ? flag_obstruction_check : 0);
+
+        // The header is written again at the end, when all offsets are known.
+        std::string bytes;
+        binary_append(bytes, &header, 1);
+        binary_pad(bytes);
+
+        Output_Buffer graph;
+        export_graph_data(graph,reader);
+        header.graph_offset = bytes.size();
+        header.graph_size = graph.size();
+        f.write(bytes.data(), bytes.size());
+        graph.write_to(f);
+        bytes.clear();
+        unsigned long long position = header.graph_offset + header.graph_size;
+        bytes.append((8 - position%8)%8, '\0');
+        position += bytes.size();
+        f.write(bytes.data(), bytes.size());
+        bytes.clear();
+
+        // Data of the examples, while filling the columns.
+        std::vector<long long> long_columns[column_data_start + 1];
+        std::vector<int> int_columns[column_type - column_K2];
+        std::vector<unsigned char> char_columns[binary_columns - column_type];
+        for (auto& column : long_columns) column.reserve(size + 1);
+        for (auto& column : int_columns) column.reserve(size);
+        for (auto& column : char_columns) column.reserve(size);
+
+        header.data_offset = position;
+        Example example;
+        for (Compact_Example* compact_example : ptr_examples) {
+            const Compact_Example& ex = *compact_example;
+            long_columns[column_test].push_back(ex.test);
+            long_columns[column_n0].push_back(ex.n[0]);
+            long_columns[column_n1].push_back(ex.n[1]);
+            long_columns[column_a0].push_back(ex.a[0]);
+            long_columns[column_a1].push_back(ex.a[1]);
+            long_columns[column_Delta].push_back(ex.Delta);
+            long_columns[column_Omega].push_back(ex.Omega);
+            long_columns[column_data_start].push_back(header.data_size + bytes.size());
+            int_columns[column_K2 - column_K2].push_back(ex.K2);
+            int_columns[column_p - column_K2].push_back(ex.p);
+            int_columns[column_q - column_K2].push_back(ex.q);
+            int_columns[column_r - column_K2].push_back(ex.r);
+            int_columns[column_worm_hole_id - column_K2].push_back(ex.worm_hole_id);
+            int_columns[column_complete_fibers - column_K2].push_back(ex.complete_fibers);
+            char_columns[column_type - column_type].push_back(ex.type);
+            char_columns[column_flags - column_type].push_back(
+                (ex.nef ? flag_nef : 0) |
+                (ex.nef_warning ? flag_nef_warning : 0) |
+                (ex.effective ? flag_effective : 0) |
+                (ex.no_obstruction ? flag_no_obstruction : 0) |
+                (ex.worm_hole ? flag_worm_hole : 0) |
+                (ex.worm_hole_conjecture_counterexample ? flag_worm_hole_conjecture_counterexample : 0)
+            );
+
+            ex.expand(example);
+            binary_example_data(bytes, example);
+            if (bytes.size() >= (1 << 20)) {
+                header.data_size += bytes.size();
+                f.write(bytes.data(), bytes.size());
+                bytes.clear();
+            }
+        }
+        header.data_size += bytes.size();
+        long_columns[column_data_start].push_back(header.data_size);
+        f.write(bytes.data(), bytes.size());
+        bytes.clear();
+        position += header.data_size;
+
+        for (int i = 0; i < binary_columns; ++i) {
+            header.column_offset[i] = position + bytes.size();
+            if (i <= column_data_start) binary_append(bytes, long_columns[i].data(), long_columns[i].size());
+            else if (i < column_type) binary_append(bytes, int_columns[i - column_K2].data(), int_columns[i - column_K2].size());
+            else binary_append(bytes, char_columns[i - column_type].data(), char_columns[i - column_type].size());
+            binary_pad(bytes);
+        }
+        f.write(bytes.data(), bytes.size());
+
+        f.seekp(0);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
         f.close();
     }
 
     // Writes a summary in a text file. (*) means that even though it says that the example is nef, it requires inspection. (**) means a counter example to the wormhole conjecture.
-    static void export_summary_text(const Reader& reader, const std::vector<Example*>& ptr_examples) {
+    static void export_summary_text(const Reader& reader, const std::vector<Compact_Example*>& ptr_examples) {
 
         std::string filename = reader.summary_filename + ".txt";
         std::ofstream f(filename);
@@ -686,8 +1089,8 @@ namespace Writer {
 
         // Here assume that the examples are sorted first by amount and second by K^2.
 
-        for (Example* ptr : ptr_examples) {
-            Example& ex = *ptr;
+        for (Compact_Example* ptr : ptr_examples) {
+            Compact_Example& ex = *ptr;
             int chain_amount = ex.type <= Example::QHD_single_j_ ? 1 : 2;
             if (ex.K2 != prevK) {
                 f << "K^2 = " << ex.K2 << ":\n";
@@ -701,20 +1104,20 @@ namespace Writer {
             if (chain_amount == 1) {
                 if (reader.summary_sort == Reader::sort_by_n_) {
                     if (ex.type == Example::single_) {
-                        f << "    (" << ex.n[0] << ',' << ex.a[0] << ") l = " << ex.chain[0].size() << '.';
+                        f << "    (" << ex.n[0] << ',' << ex.a[0] << ") l = " << ex.length[0] << '.';
                     }
                     else {
                         char c_type = ex.type - Example::QHD_single_a_ + 'a';
-                        f << "    (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ") l = " << ex.chain[0].size()-2<< '.';
+                        f << "    (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ") l = " << ex.length[0]-2<< '.';
                     }
                 }
                 else if (reader.summary_sort == Reader::sort_by_length_) {
                     if (ex.type == Example::single_) {
-                        f << "    l = " << ex.chain[0].size() << " (" << ex.n[0] << ',' << ex.a[0] << ").";
+                        f << "    l = " << ex.length[0] << " (" << ex.n[0] << ',' << ex.a[0] << ").";
                     }
                     else {
                         char c_type = ex.type - Example::QHD_single_a_ + 'a';
-                        f << "    l = " << ex.chain[0].size()-2 << " (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << ").";
+                        f << "    l = " << ex.length[0]-2 << " (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << ").";
                     }
                 }
                 if (reader.nef_check == Reader::print_) {
@@ -739,7 +1142,7 @@ namespace Writer {
             else {
                 if (reader.summary_sort == Reader::sort_by_n_) {
                     if (ex.type <= Example::p_extremal_) {
-                        auto inv = uniformize_double_by_n(ex.n,ex.a,ex.chain[0].size(),ex.chain[1].size());
+                        auto inv = uniformize_double_by_n(ex.n,ex.a,ex.length[0],ex.length[1]);
                         f << "    (" << get<0>(inv) << ',' << get<2>(inv) << ") l = " << get<4>(inv) << ", (" << get<1>(inv) << ',' << get<3>(inv) << ") l = " << get<5>(inv) << '.';
                     }
                     else {
@@ -750,12 +1153,12 @@ namespace Writer {
                         else {
                             c_type = ex.type - Example::QHD_partial_a_ + 'a';
                         }
-                        f << "    (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << ") l = " << ex.chain[0].size()-2 << ", (" << ex.n[1] << ',' << std::min(ex.a[1],ex.n[1] - ex.a[1]) << ") l = " << ex.chain[1].size() << '.';
+                        f << "    (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << ") l = " << ex.length[0]-2 << ", (" << ex.n[1] << ',' << std::min(ex.a[1],ex.n[1] - ex.a[1]) << ") l = " << ex.length[1] << '.';
                     }
                 }
                 else if (reader.summary_sort == Reader::sort_by_length_) {
                     if (ex.type <= Example::p_extremal_) {
-                        auto inv = uniformize_double_by_length(ex.n,ex.a,ex.chain[0].size(),ex.chain[1].size());
+                        auto inv = uniformize_double_by_length(ex.n,ex.a,ex.length[0],ex.length[1]);
                         f << "    l = " << get<0>(inv) << " (" << get<2>(inv) << ',' << get<4>(inv) << "), l = " << get<1>(inv) << " (" << get<3>(inv) << ',' << get<5>(inv) << "), ";
                     }
                     else {
@@ -766,7 +1169,7 @@ namespace Writer {
                         else {
                             c_type = ex.type - Example::QHD_partial_a_ + 'a';
                         }
-                        f << "    l = " << ex.chain[0].size()-2 << " (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << "), l = " << ex.chain[1].size() << " (" << ex.n[1] << ',' << std::min(ex.a[1],ex.n[1] - ex.a[1]) << "), ";
+                        f << "    l = " << ex.length[0]-2 << " (" << c_type << ';' << ex.p << ',' << ex.q << ',' << ex.r << ';' << ex.n[0] << "), l = " << ex.length[1] << " (" << ex.n[1] << ',' << std::min(ex.a[1],ex.n[1] - ex.a[1]) << "), ";
                     }
                 }
                 if (reader.summary_include_gcd) {
@@ -800,7 +1203,7 @@ namespace Writer {
 
 
     // Writes a summary in a tex file as a longtable. \dagger means that even though it says that the example is nef, it requires inspection. \ddagger means a counter example to the wormhole conjecture.
-    static void export_summary_latex(const Reader& reader, const std::vector<Example*>& ptr_examples) {
+    static void export_summary_latex(const Reader& reader, const std::vector<Compact_Example*>& ptr_examples) {
 
         std::string filename = reader.summary_filename + ".tex";
         std::ofstream f(filename);
@@ -825,8 +1228,8 @@ namespace Writer {
         // every entry which is not first in the table must append a \\\\\n at the end of the previous line.
         bool is_first = false;
 
-        for (Example* ptr : ptr_examples) {
-            Example& ex = *ptr;
+        for (Compact_Example* ptr : ptr_examples) {
+            Compact_Example& ex = *ptr;
             int chain_amount = ex.type <= Example::QHD_single_j_ ? 1 : 2;
             if (chain_amount != prev_chain_amount or prevK != ex.K2) {
                 if (prev_chain_amount != 0) {
@@ -898,11 +1301,11 @@ namespace Writer {
             }
             if (chain_amount == 1) {
                 if (ex.type == Example::single_) {
-                    f << "$(" << ex.n[0] << ", " << std::min(ex.a[0], ex.n[0] - ex.a[0]) << ")$ & " << ex.chain[0].size() << " & ";
+                    f << "$(" << ex.n[0] << ", " << std::min(ex.a[0], ex.n[0] - ex.a[0]) << ")$ & " << ex.length[0] << " & ";
                 }
                 else {
                     char c_type = ex.type - Example::QHD_single_a_ + 'a';
-                    f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.chain[0].size()-2 << " & ";
+                    f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.length[0]-2 << " & ";
                 }
                 if (reader.nef_check == Reader::print_) {
                     f << (ex.nef ? "YES" : "NO") << " & ";
@@ -925,7 +1328,7 @@ namespace Writer {
             else {
                 if (reader.summary_sort == Reader::sort_by_n_) {
                     if (ex.type <= Example::p_extremal_) {
-                        auto inv = uniformize_double_by_n(ex.n,ex.a,ex.chain[0].size(),ex.chain[1].size());
+                        auto inv = uniformize_double_by_n(ex.n,ex.a,ex.length[0],ex.length[1]);
                         f << "$(" << get<0>(inv) << ", " << get<2>(inv) << ")$ & " << get<4>(inv) << " & "
                              "$(" << get<1>(inv) << ", " << get<3>(inv) << ")$ & " << get<5>(inv) << " & ";
                     }
@@ -937,13 +1340,13 @@ namespace Writer {
                         else {
                             c_type = ex.type - Example::QHD_partial_a_ + 'a';
                         }
-                        f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.chain[0].size()-2 << " & "
-                             "$(" << ex.n[1] << ", " << std::min(ex.a[1], ex.n[1] - ex.a[1]) << ")$ & " << ex.chain[1].size() << " & ";
+                        f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.length[0]-2 << " & "
+                             "$(" << ex.n[1] << ", " << std::min(ex.a[1], ex.n[1] - ex.a[1]) << ")$ & " << ex.length[1] << " & ";
                     }
                 }
                 else if (reader.summary_sort == Reader::sort_by_length_) {
                     if (ex.type <= Example::p_extremal_) {
-                        auto inv = uniformize_double_by_length(ex.n,ex.a,ex.chain[0].size(),ex.chain[1].size());
+                        auto inv = uniformize_double_by_length(ex.n,ex.a,ex.length[0],ex.length[1]);
                         f << "$(" << get<2>(inv) << ", " << get<4>(inv) << ")$ & " << get<0>(inv) << " & "
                              "$(" << get<3>(inv) << ", " << get<5>(inv) << ")$ & " << get<1>(inv) << " & ";
                     }
@@ -955,8 +1358,8 @@ namespace Writer {
                         else {
                             c_type = ex.type - Example::QHD_partial_a_ + 'a';
                         }
-                        f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.chain[0].size()-2 << " & "
-                             "$(" << ex.n[1] << ", " << std::min(ex.a[1], ex.n[1] - ex.a[1]) << ")$ & " << ex.chain[1].size() << " & ";
+                        f << "$(" << c_type << "; " << ex.p << ", " << ex.q << ", " << ex.r << "; " << ex.n[0] << ")$ & " << ex.length[0]-2 << " & "
+                             "$(" << ex.n[1] << ", " << std::min(ex.a[1], ex.n[1] - ex.a[1]) << ")$ & " << ex.length[1] << " & ";
                     }
                 }
                 if (reader.summary_include_gcd) {
@@ -1000,29 +1403,266 @@ namespace Writer {
     }
 
     #ifdef EXPORT_PRETEST_DATA
-    static void export_pretest_data(const Reader& reader, const std::vector<long long> passed_pretest_list) {
+    // Merges the pretest files of the threads into one, in increasing order, and removes them. See Pretest_Stream for the format.
+    static void export_pretest_data(const Reader& reader, const std::vector<Pretest_Stream*>& parts) {
 
         std::string filename = reader.pretest_filename;
-        std::ofstream f(filename);
-        if (f.fail()) {
+        Pretest_Stream merged;
+        if (!merged.open(filename)) {
             std::cout << "Error while opening file \"" << filename << "\"." << std::endl;
             filename = DEFAULT_PRETEST_NAME;
             std::cout << "Attempting to open default file \"" << filename << "\"." << std::endl;
-            f.clear();
-            f.open(filename);
-            if (f.fail()) {
+            if (!merged.open(filename)) {
                 std::cout << "Also failed. Aborting pretest data export." << std::endl;
                 return;
             }
         }
 
-        for (long long x : passed_pretest_list) {
-            f << x << '\n';
+        // The tests of each thread are already increasing, so keep the next test of each file in a priority queue.
+        std::vector<std::ifstream> inputs(parts.size());
+        std::vector<long long> next(parts.size(), 0);
+        std::priority_queue<std::pair<long long,int>, std::vector<std::pair<long long,int>>, std::greater<std::pair<long long,int>>> q;
+        for (int i = 0; i < parts.size(); ++i) {
+            inputs[i].open(parts[i]->filename, std::ios::binary);
+            if (Pretest_Stream::read_magic(inputs[i]) and Pretest_Stream::read(inputs[i], next[i])) {
+                q.emplace(next[i], i);
+            }
+        }
+        while (!q.empty()) {
+            const int i = q.top().second;
+            q.pop();
+            merged.push(next[i]);
+            if (Pretest_Stream::read(inputs[i], next[i])) {
+                q.emplace(next[i], i);
+            }
         }
+        merged.close();
 
-        f.close();
+        for (int i = 0; i < parts.size(); ++i) {
+            inputs[i].close();
+            std::remove(parts[i]->filename.c_str());
+        }
+        std::cout << "Exported " << merged.count << " pretests to \"" << filename << "\"." << std::endl;
     }
     #endif //EXPORT_PRETEST_DATA
+
+    // Writes the reader.slowest_tests slowest sub-tests among those kept by each thread to <Output>_slowest.txt,
+    // slowest first, each with the SubTests line that searches only it.
+    static void export_slowest_tests(const Reader& reader, const std::vector<Slow_Test_Heap*>& heaps) {
+        std::vector<Slow_Test> slowest;
+        for (Slow_Test_Heap* heap : heaps) {
+            while (!heap->empty()) {
+                slowest.push_back(heap->top());
+                heap->pop();
+            }
+        }
+        std::sort(slowest.begin(), slowest.end(), std::greater<Slow_Test>());
+        if (slowest.size() > (size_t) reader.slowest_tests) slowest.resize(reader.slowest_tests);
+
+        std::string filename = reader.output_filename + "_slowest.txt";
+        std::ofstream f(filename);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting slowest sub-tests export." << std::endl;
+            return;
+        }
+        f << "# seconds, sub-test, test, mask, curves, separations, candidates, and the line to search only that sub-test.\n";
+        if (reader.estimate > 0) {
+            f << "# SubTests counts positions in the sample of Estimate.\n";
+        }
+        else if (reader.heuristic_order) {
+            f << "# SubTests counts positions in the order of Search_Order: Heuristic.\n";
+        }
+        else if (!reader.pretest_input_filename.empty()) {
+            f << "# SubTests counts positions in the Pretest_Input file \"" << reader.pretest_input_filename << "\".\n";
+        }
+        for (const Slow_Test& t : slowest) {
+            f << std::to_string(t.seconds) << ' ' << t.test << ' ' << t.test_number << ' ' << t.mask << ' '
+              << t.graph_size << ' ' << t.separations << ' ' << t.candidates
+              << "    SubTests: " << t.position << " - " << t.position + 1 << '\n';
+        }
+        f.close();
+        std::cout << "Exported the " << slowest.size() << " slowest sub-tests to \"" << filename << "\"." << std::endl;
+    }
+
+    // Writes the sub-tests that went over a budget to <Output>_retry.wpre, in the format of Export_Pretests, so that they can
+    // be searched again with Pretest_Input and larger budgets.
+    static void export_retry_tests(const Reader& reader, const std::vector<std::vector<long long>*>& suspended) {
+        std::vector<long long> tests;
+        for (auto part : suspended) {
+            tests.insert(tests.end(), part->begin(), part->end());
+        }
+        std::sort(tests.begin(), tests.end());
+
+        std::string filename = reader.output_filename + "_retry.wpre";
+        Pretest_Stream retry;
+        if (!retry.open(filename)) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting retry export." << std::endl;
+            return;
+        }
+        for (long long test : tests) {
+            retry.push(test);
+        }
+        retry.close();
+        std::cout << tests.size() << " sub-tests went over budget. Exported them to \"" << filename << "\"." << std::endl;
+    }
+
+    // Extrapolates the sample searched with Estimate to all the sub-tests it was taken from, and writes it to <Output>_estimate.txt.
+    // Each of the Tests is a stratum: the total of a quantity is estimated as the sum over the strata of its mean in the sample
+    // times the size of the stratum, and its variance as the sum of size^2 (1 - sampled/size) variance/sampled.
+    static void export_estimate(const Reader& reader, long long population, const std::vector<long long>& strata,
+                                const std::vector<std::vector<Estimate_Sample>*>& parts, const std::vector<Compact_Example>& examples) {
+        std::vector<Estimate_Sample> samples;
+        for (auto part : parts) {
+            for (const Estimate_Sample& sample : *part) {
+                // Samples interrupted by SIGINT are not finished.
+                if (sample.seconds >= 0) samples.push_back(sample);
+            }
+        }
+        std::sort(samples.begin(), samples.end(), [] (const Estimate_Sample& a, const Estimate_Sample& b) { return a.position < b.position; });
+
+        // One column for each quantity, with its value in each sample.
+        static const char* kind_names[] = {"single", "double", "p_extremal", "QHD_single", "QHD_double"};
+        std::vector<std::string> names = {"passed_pretests", "sub-tests_with_examples", "examples"};
+        for (const char* kind : kind_names) names.push_back(std::string("examples_") + kind);
+        std::map<int,int> K2_column;
+        for (const Compact_Example& ex : examples) {
+            if (!K2_column.count(ex.K2)) K2_column[ex.K2] = 0;
+        }
+        for (auto& p : K2_column) {
+            p.second = names.size();
+            names.push_back("examples_K2=" + std::to_string(p.first));
+        }
+        const int seconds_column = names.size();
+        names.push_back("thread_seconds");
+
+        std::vector<std::vector<double>> values(samples.size(), std::vector<double>(names.size(), 0));
+        for (size_t i = 0; i < samples.size(); ++i) {
+            values[i][0] = samples[i].passed_pretest;
+            values[i][seconds_column] = samples[i].seconds;
+        }
+        for (const Compact_Example& ex : examples) {
+            auto iter = std::lower_bound(samples.begin(), samples.end(), ex.test, [] (const Estimate_Sample& s, long long position) { return s.position < position; });
+            if (iter == samples.end() or iter->position != ex.test) continue;
+            auto& row = values[iter - samples.begin()];
+            int kind = ex.type == Example::single_ ? 0 : ex.type == Example::double_ ? 1 : ex.type == Example::p_extremal_ ? 2 :
+                       ex.type <= Example::QHD_single_j_ ? 3 : 4;
+            row[1] = 1;
+            row[2]++;
+            row[3 + kind]++;
+            row[K2_column[ex.K2]]++;
+        }
+
+        // Sums and sums of squares of each column in each stratum.
+        const int columns = names.size();
+        std::vector<long long> sampled(strata.size(), 0);
+        std::vector<std::vector<double>> sum(strata.size(), std::vector<double>(columns, 0)), sum_squares = sum;
+        for (size_t i = 0; i < samples.size(); ++i) {
+            int h = samples[i].test_index;
+            sampled[h]++;
+            for (int c = 0; c < columns; ++c) {
+                sum[h][c] += values[i][c];
+                sum_squares[h][c] += values[i][c]*values[i][c];
+            }
+        }
+        std::vector<double> total(columns, 0), variance(columns, 0);
+        long long unsampled = 0;
+        for (size_t h = 0; h < strata.size(); ++h) {
+            if (strata[h] == 0) continue;
+            if (sampled[h] == 0) {
+                unsampled += strata[h];
+                continue;
+            }
+            const double N = strata[h], n = sampled[h];
+            for (int c = 0; c < columns; ++c) {
+                const double mean = sum[h][c]/n;
+                total[c] += N*mean;
+                if (sampled[h] > 1) {
+                    const double s2 = std::max(0., (sum_squares[h][c] - n*mean*mean)/(n - 1));
+                    variance[c] += N*N*(1 - n/N)*s2/n;
+                }
+            }
+        }
+
+        std::string filename = reader.output_filename + "_estimate.txt";
+        std::ofstream f(filename);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting estimate export." << std::endl;
+            return;
+        }
+        f << "# Estimate for " << population << " sub-tests, from a sample of " << samples.size() << " taken from each of the Tests in proportion to its size.\n";
+        f << "# Each line is the estimated total and the half width of its 95% confidence interval.\n";
+        f << "# Examples are counted in each sub-test on its own, so invariants found in several sub-tests are counted several times.\n";
+        if (unsampled > 0) {
+            f << "# " << unsampled << " sub-tests are in Tests without samples, and are not counted.\n";
+        }
+        for (int c = 0; c < columns; ++c) {
+            f << names[c] << ' ' << std::to_string(total[c]) << " +- " << std::to_string(1.96*std::sqrt(variance[c])) << '\n';
+        }
+#ifdef MULTITHREAD
+        f << "wall_hours_with_" << reader.threads << "_threads " << std::to_string(total[seconds_column]/3600./reader.threads)
+          << " +- " << std::to_string(1.96*std::sqrt(variance[seconds_column])/3600./reader.threads) << '\n';
+#endif
+        f << "# For each of the Tests: its sub-tests, the ones sampled, the pretests passed in the sample and the average seconds per sampled sub-test.\n";
+        for (size_t h = 0; h < strata.size(); ++h) {
+            if (strata[h] == 0) continue;
+            f << "Test " << reader.tests_start_index + h + 1 << ' ' << strata[h] << ' ' << sampled[h] << ' ' << (long long)sum[h][0]
+              << ' ' << std::to_string(sampled[h] ? sum[h][seconds_column]/sampled[h] : 0.) << '\n';
+        }
+        f.close();
+        std::cout << "Estimated " << (long long)total[0] << " passed pretests, " << (long long)total[2] << " examples and "
+                  << std::to_string(total[seconds_column]/3600.) << " hours of search in one thread. Exported the estimate to \"" << filename << "\"." << std::endl;
+    }
+
+    #ifdef SEARCH_STATS
+    static void export_stats_object(Output_Buffer& f, const Search_Stats& stats) {
+        f << "{\"tests\":" << stats.tests
+          << ",\"ignored_tests\":" << stats.ignored_tests
+          << ",\"passed_pretests\":" << stats.passed_pretests
+          << ",\"obstructed\":" << stats.obstructed
+          << ",\"separations\":" << stats.separations;
+        f << ",\"seconds\":{";
+        for (int i = 0; i < Search_Stats::stages; ++i) {
+            if (i) f << ',';
+            f << '"' << Search_Stats::stage_names[i] << "\":" << std::to_string(stats.nanoseconds[i]*1e-9);
+        }
+        f << '}';
+        for (int i = 0; i < Search_Stats::kinds; ++i) {
+            f << ",\"" << Search_Stats::kind_names[i] << "\":{"
+              << "\"explored\":" << stats.explored[i]
+              << ",\"reduced\":" << stats.reduced[i]
+              << ",\"hits\":" << stats.hits[i]
+              << ",\"repeated\":" << stats.repeated[i]
+              << ",\"not_nef\":" << stats.not_nef[i]
+              << ",\"not_effective\":" << stats.not_effective[i]
+              << ",\"examples\":" << stats.examples[i] << '}';
+        }
+        f << '}';
+    }
+
+    // Writes the counters and timers of each thread, and their total, to <Output>_stats.json.
+    static void export_stats(const Reader& reader, const std::vector<const Search_Stats*>& stats) {
+        std::string filename = reader.output_filename + "_stats.json";
+        std::ofstream f(filename);
+        if (f.fail()) {
+            std::cout << "Error while opening file \"" << filename << "\". Aborting stats export." << std::endl;
+            return;
+        }
+        Search_Stats total;
+        Output_Buffer buffer;
+        buffer << "{\"threads\":[";
+        for (int i = 0; i < stats.size(); ++i) {
+            if (i) buffer << ",\n";
+            else buffer << '\n';
+            export_stats_object(buffer, *stats[i]);
+            total.add(*stats[i]);
+        }
+        buffer << "],\n\"total\":";
+        export_stats_object(buffer, total);
+        buffer << "}\n";
+        buffer.write_to(f);
+        f.close();
+    }
+    #endif // SEARCH_STATS
 }
 
 #endif
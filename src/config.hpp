@@ -53,15 +53,42 @@
 #define PRINT_PASSED_PRETESTS_END
 
 // Export Passed Pretest Data
+// Each thread streams its passed pretests to its own file, and the files are merged at the end. There is no limit on the amount.
 
 #define EXPORT_PRETEST_DATA
 
-// Maximum amount of pretests to export
+// Checks set to Print don't discard examples, so do them only over the examples that remain after removing repetitions.
+// Each example keeps enough data to rebuild its sub-test, and the checks are split between threads before writing.
 
-#ifndef MAX_PRETEST_EXPORTED
-#define MAX_PRETEST_EXPORTED 10000
+#define DEFER_PRINT_CHECKS
+
+// With Keep_First global, threads share the smallest test where each invariant was found, and skip candidates that were already found in a previous test.
+// Only saves work: the examples are still merged in order at the end, so the result doesn't change. Does nothing without multithread.
+
+#define SHARE_FOUND_INVARIANTS
+
+// Capacity of the shared table, as a power of two.
+
+#ifndef SHARED_FOUND_LOG_SIZE
+#define SHARED_FOUND_LOG_SIZE 18
+#endif
+
+// Next to the jsonl file, write an index with the offset of each example and the examples grouped by K^2, type and n.
+
+#define EXPORT_JSONL_INDEX
+
+// Examples written by each thread at a time when exporting the jsonl file.
+
+#ifndef EXPORT_BLOCK_SIZE
+#define EXPORT_BLOCK_SIZE 4096
 #endif
 
+// Count and time each stage of the search in every thread: loading the test, contracting exceptional curves, the pretest,
+// building the graph, the obstruction check, the separations visited and the candidates of each kind of search.
+// The totals are written to <Output>_stats.json at the end and shown in the status. Costs a few clock reads per test.
+
+// #define SEARCH_STATS
+
 // Define to catch SIGINT and export whatever examples where found until that point
 
 #define CATCH_SIGINT
@@ -86,7 +113,7 @@
 
 #define DEFAULT_OUTPUT_NAME "OUT"
 #define DEFAULT_SUMMARY_NAME "SUMMARY"
-#define DEFAULT_PRETEST_NAME "PRETESTS.txt"
+#define DEFAULT_PRETEST_NAME "PRETESTS.wpre"
 #define ERROR_FILE "ERRORS.log"
 
 #include<iostream>
@@ -144,6 +171,9 @@ do {                                            \
 // on single thread, disable thread_local storages.
 #define THREAD_STATIC static
 
+// There is only one searcher, so nothing to share.
+#undef SHARE_FOUND_INVARIANTS
+
 #else
 #ifdef __MINGW32__
 // On mingw-g++, do not use thread_local storage because bugs???
@@ -49,7 +49,7 @@ void Searcher::search_for_double_chain() {
 #endif
 
     G.begin_search();
-    do { search_for_double_chain_inner_loop(); } while (G.next_candidate());
+    do { separations++; search_for_double_chain_inner_loop(); } while (!over_budget() and G.next_candidate());
 }
 
 template<bool chain_search, bool QHD_search>
@@ -340,6 +340,10 @@ Fifth case: The connection C_0 -> C_1 ends at the begining of C_1
 */
 
 void Searcher::explore_double_candidate(vector<int> (&chain)[2]) {
+    if (over_budget()) return;
+    candidates++;
+    STATS(stats.explored[Search_Stats::kind_double]++;)
+    if (reader.search_targets and reader.target_wahl.empty()) return;
     // to which chain belongs a curve.
     THREAD_STATIC vector<int> location;
     // For swapping chains in O(1)
@@ -504,7 +508,11 @@ void Searcher::explore_double_candidate(vector<int> (&chain)[2]) {
                 }
 #endif
 
-                if (invariants.first != 0) {
+                // If the first chain is not a target, there is no need to explore the second.
+                const bool first_is_target = !reader.search_targets or contains(reader.target_wahl,
+                    std::make_pair(invariants.first,std::min(invariants.second,invariants.first - invariants.second)));
+
+                if (invariants.first != 0 and first_is_target) {
                     int last = -1;
                     for (int A : G.disconnections[end]) if (location[A] == 1) {
                         if (last == A) continue;
@@ -741,6 +749,10 @@ void Searcher::verify_first_explore_independent_second(vector<int> (&chain)[2],
 #endif
 
         if (invariants.first == 0) return;
+
+        // If the first chain is not a target, there is no need to explore the second.
+        if (reader.search_targets and !contains(reader.target_wahl,
+            std::make_pair(invariants.first,std::min(invariants.second,invariants.first - invariants.second)))) return;
     }
 
     THREAD_STATIC unordered_set<int> ignore;
@@ -869,6 +881,10 @@ void Searcher::verify_first_explore_independent_second(vector<int> (&chain)[2],
 
 
 void Searcher::explore_p_extremal_resolution(vector<int>& chain) {
+    if (over_budget()) return;
+    candidates++;
+    STATS(stats.explored[Search_Stats::kind_p_extremal]++;)
+    if (reader.search_targets and reader.target_p_extremal.empty()) return;
     const int size = G.size;
 
     THREAD_STATIC vector<int> reduced_self_int;
@@ -960,9 +976,17 @@ void Searcher::explore_p_extremal_resolution(vector<int>& chain) {
 }
 
 void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vector<int>& local_self_int, int extra_n[2], int extra_orig[2], int extra_pos[2]) {
+    STATS(stats.reduced[Search_Stats::kind_double]++;)
+    if (reader.search_targets and (
+        !contains(reader.target_wahl_lengths,(int)chain[0].size()) or
+        !contains(reader.target_wahl_lengths,(int)chain[1].size())
+    )) return;
 
     std::pair<long long, long long> invariants[2];
     invariants[0] = algs::get_wahl_numbers(chain[0],local_self_int);
+
+    // Most candidates already fail with the first chain.
+    if (invariants[0].first == 0) return;
     invariants[1] = algs::get_wahl_numbers(chain[1],local_self_int);
     long long n[2] = {invariants[0].first, invariants[1].first};
     long long a[2] = {invariants[0].second, invariants[1].second};
@@ -983,17 +1007,33 @@ void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vect
 #endif
 
     if (invariants[0].first == 0 or invariants[1].first == 0) return;
-    double_invariant unif_invariants(current_K2,n[0],std::min(a[0],n[0]-a[0]),n[1],std::min(a[1],n[1]-a[1]));
+    if (reader.search_targets and (
+        !contains(reader.target_wahl,std::make_pair(n[0],std::min(a[0],n[0]-a[0]))) or
+        !contains(reader.target_wahl,std::make_pair(n[1],std::min(a[1],n[1]-a[1])))
+    )) return;
+    long long unif_n[2] = {n[0],n[1]};
+    long long unif_a[2] = {std::min(a[0],n[0]-a[0]),std::min(a[1],n[1]-a[1])};
 
     if (n[0] < n[1]) {
-        std::swap(std::get<1>(unif_invariants),std::get<3>(unif_invariants));
-        std::swap(std::get<2>(unif_invariants),std::get<4>(unif_invariants));
+        std::swap(unif_n[0],unif_n[1]);
+        std::swap(unif_a[0],unif_a[1]);
     }
 
-    if (n[0] == n[1] and std::get<2>(unif_invariants) < std::get<4>(unif_invariants)) {
-        std::swap(std::get<2>(unif_invariants),std::get<4>(unif_invariants));
+    if (n[0] == n[1] and unif_a[0] < unif_a[1]) {
+        std::swap(unif_a[0],unif_a[1]);
+    }
+    STATS(stats.hits[Search_Stats::kind_double]++;)
+    const Invariant_Key key = Invariant_Key::double_chain(current_K2,unif_n[0],unif_a[0],unif_n[1],unif_a[1]);
+    if (keep_first != Reader::no_ and contains(double_found,key)) {
+        STATS(stats.repeated[Search_Stats::kind_double]++;)
+        return;
+    }
+#ifdef SHARE_FOUND_INVARIANTS
+    if (found_before(key)) {
+        STATS(stats.repeated[Search_Stats::kind_double]++;)
+        return;
     }
-    if (reader_copy.keep_first != Reader::no_ and contains(double_found,unif_invariants)) return;
+#endif
 
     // Chain is Wahl, and we haven't seen these invariants before.
 
@@ -1008,19 +1048,21 @@ void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vect
     for (int curve : chain[1]) location[curve] = 1;
 
     pair<bool,bool> nef_result;
-    if (reader_copy.nef_check != Reader::no_) {
+    if (check_now(reader.nef_check)) {
         int borders[2] = {chain[0].back(),chain[1].back()};
         nef_result = double_is_nef(local_self_int,discrepancies,location,n,extra_n,extra_orig,extra_pos,borders);
     }
-    if (reader_copy.nef_check == Reader::skip_ and !nef_result.first) {
+    if (reader.nef_check == Reader::skip_ and !nef_result.first) {
+        STATS(stats.not_nef[Search_Stats::kind_double]++;)
         return;
     }
 
     bool effective = false;
-    if (reader_copy.effective_check != Reader::no_) {
+    if (check_now(reader.effective_check)) {
         effective = double_is_effective(local_self_int,discrepancies,location,n);
     }
-    if (reader_copy.effective_check == Reader::skip_ and !effective) {
+    if (reader.effective_check == Reader::skip_ and !effective) {
+        STATS(stats.not_effective[Search_Stats::kind_double]++;)
         return;
     }
 
@@ -1032,7 +1074,7 @@ void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vect
     example.K2 = current_K2;
     example.complete_fibers = current_complete_fibers;
     example.used_curves.insert(curve_translate.begin(),curve_translate.end());
-    for (int exceptional : reader_copy.K.used_components) {
+    for (int exceptional : reader.K.used_components) {
         if (temp_self_int[exceptional] == INT_MAX) {
             example.blown_down_exceptionals.insert(exceptional);
         }
@@ -1048,6 +1090,8 @@ void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vect
     example.extra_orig[1] = extra_orig[1];
     example.extra_pos[0] = extra_pos[0];
     example.extra_pos[1] = extra_pos[1];
+    example.extra_border[0] = chain[0].back();
+    example.extra_border[1] = chain[1].back();
     example.chain[0] = chain[0];
     example.chain[1] = chain[1];
     example.self_int = local_self_int;
@@ -1057,11 +1101,14 @@ void Searcher::verify_double_candidate(const vector<int> (&chain)[2], const vect
     example.nef_warning = nef_result.second;
     example.effective = effective;
 
-    results->push(std::move(example));
+    push_result(example);
 
-    if (reader_copy.keep_first != Reader::no_) {
-        double_found.insert(unif_invariants);
+    if (keep_first != Reader::no_) {
+        double_found.insert(key);
     }
+#ifdef SHARE_FOUND_INVARIANTS
+    share_found(key);
+#endif
 }
 
 /*
@@ -1070,10 +1117,13 @@ For every pair of possitions in the dual, add 1 in those possitions and check if
 If it does, the invariants of both singularities can be obtained from this dual chain. Construct the sequence representing those Wahl singularities and compare the sequence to the original (non reduced) chain to keep track of non contracted curves.
 */
 void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, const vector<int>& reduced_self_int, const vector<int>& chain, int extra_n, int extra_orig, int extra_pos) {
+    STATS(stats.reduced[Search_Stats::kind_p_extremal]++;)
 
     THREAD_STATIC vector<int> dual_chain;
     THREAD_STATIC vector<pair<int,int>> pairs;
 
+    if (reader.search_targets and !contains(reader.target_p_extremal_lengths,(int)reduced_chain.size())) return;
+
     const auto fraction = algs::to_rational(reduced_chain,reduced_self_int);
 
 #ifdef OVERFLOW_CHECK
@@ -1094,11 +1144,22 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
 
     long long Omega_unif = algs::gcd_invmod(Delta,Omega).second;
 
-    P_extremal_invariant unif_invariants = std::make_tuple(current_K2,Delta,std::min(Omega,Omega_unif));
+    if (reader.search_targets and !contains(reader.target_p_extremal,std::make_pair(Delta,std::min(Omega,Omega_unif)))) return;
+    STATS(stats.hits[Search_Stats::kind_p_extremal]++;)
+    const Invariant_Key key = Invariant_Key::p_extremal(current_K2,Delta,std::min(Omega,Omega_unif));
 
-    if (reader_copy.keep_first != Reader::no_) {
-        if (contains(P_extremal_found,unif_invariants)) return;
+    if (keep_first != Reader::no_) {
+        if (contains(P_extremal_found,key)) {
+            STATS(stats.repeated[Search_Stats::kind_p_extremal]++;)
+            return;
+        }
     }
+#ifdef SHARE_FOUND_INVARIANTS
+    if (found_before(key)) {
+        STATS(stats.repeated[Search_Stats::kind_p_extremal]++;)
+        return;
+    }
+#endif
 
     algs::to_chain(Delta,Delta - Omega,dual_chain);
 
@@ -1204,13 +1265,14 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
         algs::get_discrepancies(n1,a1,Wahl_chains[1],discrepancies);
 
         pair<bool,bool> nef_result(false,false);
-        if (reader_copy.nef_check != Reader::no_) {
+        if (check_now(reader.nef_check)) {
             int borders[2] = {Wahl_chains[0].back(), Wahl_chains[1].back()};
             nef_result = double_is_nef(bd_linked_list.self_int, discrepancies,
                 bd_linked_list.location,n,_temp_extra_n,_temp_extra_orig,_temp_extra_pos,borders);
 
         }
-        if (reader_copy.nef_check == Reader::skip_ and !nef_result.first) {
+        if (reader.nef_check == Reader::skip_ and !nef_result.first) {
+            STATS(stats.not_nef[Search_Stats::kind_p_extremal]++;)
             if (pair_index == 1 and first_included) {
                 // counter example to wormhole conjecture.
                 results->back().worm_hole_conjecture_counterexample = true;
@@ -1219,10 +1281,11 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
         }
 
         bool effective = false;
-        if (reader_copy.effective_check != Reader::no_) {
+        if (check_now(reader.effective_check)) {
             effective = double_is_effective(bd_linked_list.self_int, discrepancies, bd_linked_list.location, n);
         }
-        if (reader_copy.effective_check == Reader::skip_ and !effective) {
+        if (reader.effective_check == Reader::skip_ and !effective) {
+            STATS(stats.not_effective[Search_Stats::kind_p_extremal]++;)
             if (pair_index == 1 and first_included) {
                 // counter example to wormhole conjecture.
                 results->back().worm_hole_conjecture_counterexample = true;
@@ -1238,7 +1301,7 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
         example.K2 = current_K2;
         example.complete_fibers = current_complete_fibers;
         example.used_curves.insert(curve_translate.begin(),curve_translate.end());
-        for (int exceptional : reader_copy.K.used_components) {
+        for (int exceptional : reader.K.used_components) {
             if (temp_self_int[exceptional] == INT_MAX) {
                 example.blown_down_exceptionals.insert(exceptional);
             }
@@ -1254,6 +1317,8 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
         example.extra_orig[1] = _temp_extra_orig[1];
         example.extra_pos[0] = _temp_extra_pos[0];
         example.extra_pos[1] = _temp_extra_pos[1];
+        example.extra_border[0] = Wahl_chains[0].back();
+        example.extra_border[1] = Wahl_chains[1].back();
         example.chain[0] = std::move(Wahl_chains[0]);
         example.chain[1] = std::move(Wahl_chains[1]);
         example.self_int = std::move(bd_linked_list.self_int);
@@ -1269,13 +1334,16 @@ void Searcher::verify_p_extremal_resolution(const vector<int>& reduced_chain, co
         example.nef_warning = nef_result.second;
         example.effective = effective;
 
-        results->push(std::move(example));
+        push_result(example);
 
         first_included = true;
 
-        if (reader_copy.keep_first != Reader::no_) {
-            P_extremal_found.insert(unif_invariants);
+        if (keep_first != Reader::no_) {
+            P_extremal_found.insert(key);
         }
+#ifdef SHARE_FOUND_INVARIANTS
+        share_found(key);
+#endif
     }
     pairs.clear();
 }
@@ -1335,7 +1403,7 @@ pair<bool,bool> Searcher::double_is_nef(const std::vector<int>& local_self_int,
     Calculations are done in common denominator n0*n1
     */
     bool nef_warning = false;
-    for (auto& exceptional : reader_copy.K.components) {
+    for (auto& exceptional : reader.K.components) {
         if (temp_self_int[exceptional.id] == INT_MAX) {
             continue;
         }
@@ -1390,7 +1458,7 @@ bool Searcher::double_is_effective(const std::vector<int>& local_self_int, const
     // Here, all calculations are done in numerators with common denominator 2*n[0]*n[1].
     // I really doubt there is an example with at least two complete fibers which fails this test.
     long long sum = 0;
-    for (auto& fiber : reader_copy.fibers) {
+    for (auto& fiber : reader.fibers) {
         long long minval = n[0]*n[1];
         for (int curve : fiber) {
             auto iter = curve_dict.find(curve);
@@ -3,6 +3,8 @@
 int main(int argc, char** argv) {
     if (argc < 2) {
         std::cout << "Usage: " << argv[0] << " <filename>" << std::endl;
+        std::cout << "       " << argv[0] << " --reexport <jsonl file> [filename]" << std::endl;
+        std::cout << "       " << argv[0] << " --batch <filename | @manifest>..." << std::endl;
         return 0;
     }
     Wahl p(argc,argv);
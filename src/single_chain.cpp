@@ -39,7 +39,7 @@ void Searcher::search_for_single_chain() {
 #endif
 
     G.begin_search();
-    do { search_for_single_chain_inner_loop(); } while (G.next_candidate());
+    do { separations++; search_for_single_chain_inner_loop(); } while (!over_budget() and G.next_candidate());
 }
 
 template<bool chain_search, bool QHD_search>
@@ -130,6 +130,9 @@ Let A be the curve at the other end of the connection. Reduce the chain, but avo
 
 */
 void Searcher::explore_single_candidate(vector<int>& chain) {
+    if (over_budget()) return;
+    candidates++;
+    STATS(stats.explored[Search_Stats::kind_single]++;)
     /////////////////////////////////////////////////
     // Temporary stuff for reducing chains
 
@@ -230,6 +233,9 @@ void Searcher::explore_single_candidate(vector<int>& chain) {
 }
 
 void Searcher::verify_single_candidate(const vector<int>& chain, const vector<int>& local_self_int, int extra_n, int extra_orig, int extra_pos) {
+    STATS(stats.reduced[Search_Stats::kind_single]++;)
+    if (reader.search_targets and !contains(reader.target_wahl_lengths,(int)chain.size())) return;
+
     auto invariants = algs::get_wahl_numbers(chain,local_self_int);
     const long long n = invariants.first;
     const long long a = invariants.second;
@@ -246,8 +252,19 @@ void Searcher::verify_single_candidate(const vector<int>& chain, const vector<in
 #endif
 
     if (invariants.first == 0) return;
-    single_invariant unif_invariants(current_K2,n,std::min(a,n-a));
-    if (reader_copy.keep_first != Reader::no_ and contains(single_found,unif_invariants)) return;
+    if (reader.search_targets and !contains(reader.target_wahl,std::make_pair(n,std::min(a,n-a)))) return;
+    STATS(stats.hits[Search_Stats::kind_single]++;)
+    const Invariant_Key key = Invariant_Key::single(current_K2,n,std::min(a,n-a));
+    if (keep_first != Reader::no_ and contains(single_found,key)) {
+        STATS(stats.repeated[Search_Stats::kind_single]++;)
+        return;
+    }
+#ifdef SHARE_FOUND_INVARIANTS
+    if (found_before(key)) {
+        STATS(stats.repeated[Search_Stats::kind_single]++;)
+        return;
+    }
+#endif
 
     // Chain is Wahl, and we haven't seen these invariants before.
     THREAD_STATIC vector<long long> discrepancies;
@@ -255,20 +272,22 @@ void Searcher::verify_single_candidate(const vector<int>& chain, const vector<in
     algs::get_discrepancies(invariants.first, invariants.second, chain, discrepancies);
 
     pair<bool,bool> nef_result = {false,false};
-    if (reader_copy.nef_check != Reader::no_) {
+    if (check_now(reader.nef_check)) {
         nef_result = single_is_nef(local_self_int,
             discrepancies,n,extra_n,extra_orig,extra_pos,chain.back());
     }
-    if (reader_copy.nef_check == Reader::skip_ and !nef_result.first) {
+    if (reader.nef_check == Reader::skip_ and !nef_result.first) {
+        STATS(stats.not_nef[Search_Stats::kind_single]++;)
         return;
     }
 
     bool effective = false;
-    if (reader_copy.effective_check != Reader::no_) {
+    if (check_now(reader.effective_check)) {
         effective = single_is_effective(local_self_int,
             discrepancies,n);
     }
-    if (reader_copy.effective_check == Reader::skip_ and !effective) {
+    if (reader.effective_check == Reader::skip_ and !effective) {
+        STATS(stats.not_effective[Search_Stats::kind_single]++;)
         return;
     }
 
@@ -279,7 +298,7 @@ void Searcher::verify_single_candidate(const vector<int>& chain, const vector<in
     example.K2 = current_K2;
     example.complete_fibers = current_complete_fibers;
     example.used_curves.insert(curve_translate.begin(),curve_translate.end());
-    for (int exceptional : reader_copy.K.used_components) {
+    for (int exceptional : reader.K.used_components) {
         if (temp_self_int[exceptional] == INT_MAX) {
             example.blown_down_exceptionals.insert(exceptional);
         }
@@ -290,6 +309,7 @@ void Searcher::verify_single_candidate(const vector<int>& chain, const vector<in
     example.extra_n[0] = extra_n;
     example.extra_orig[0] = extra_orig;
     example.extra_pos[0] = extra_pos;
+    example.extra_border[0] = chain.back();
     example.chain[0] = chain;
     example.self_int = local_self_int;
     example.discrepancies = std::move(discrepancies);
@@ -298,11 +318,14 @@ void Searcher::verify_single_candidate(const vector<int>& chain, const vector<in
     example.nef_warning = nef_result.second;
     example.effective = effective;
 
-    results->push(std::move(example));
+    push_result(example);
 
-    if (reader_copy.keep_first != Reader::no_) {
-        single_found.insert(unif_invariants);
+    if (keep_first != Reader::no_) {
+        single_found.insert(key);
     }
+#ifdef SHARE_FOUND_INVARIANTS
+    share_found(key);
+#endif
 }
 
 
@@ -351,7 +374,7 @@ pair<bool,bool> Searcher::single_is_nef(
     Else ignore.
     */
     bool nef_warning = false;
-    for (auto& exceptional : reader_copy.K.components) {
+    for (auto& exceptional : reader.K.components) {
         if (temp_self_int[exceptional.id] == INT_MAX) {
             continue;
         }
@@ -405,7 +428,7 @@ bool Searcher::single_is_effective(const vector<int>& local_self_int, const vect
     // Here, all calculations are done in numerators with common denominator 2n.
     // I really doubt there is an example with at least two complete fibers which fails this test.
     long long sum = 0;
-    for (auto& fiber : reader_copy.fibers) {
+    for (auto& fiber : reader.fibers) {
         long long minval = n;
         for (int curve : fiber) {
             auto iter = curve_dict.find(curve);